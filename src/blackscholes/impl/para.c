@@ -1,23 +1,188 @@
 /* para.c
  *
- * Author:
- * Date  :
+ * Author: Khalid Al-Hawaj
+ * Date  : 16 Oct. 2026
  *
- *  Description
+ * Multithreaded implementation: the options are split in one contiguous
+ * range per thread, and each (pinned) worker runs the AVX2 kernel over
+ * its range in chunks of PARA_CHUNK options, so that the working set of
+ * the SoA arrays of a chunk stays in the private caches.
+ *
+ * The ranges start and end on cache lines of output, which are whole
+ * vectors too, so that no two threads write the same line; only the
+ * last range ends at num_stocks. The Greeks (--greeks) are placed at the
+ * offset of output, so their lines are split the same way. With
+ * --implied-vol, every worker counts its solver iterations in its own
+ * slot of iv_stats.
  */
 
+#define _GNU_SOURCE
+
 /* Standard C includes */
 #include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <sched.h>
 
 /* Include common headers */
 #include "common/macros.h"
 #include "common/types.h"
+#include "common/timer.h"
+#include "common/pool.h"
+
+/* If we are on Darwin, include the compatibility header */
+#if defined(__APPLE__)
+#include "common/mach_pthread_compatibility.h"
+#endif
 
 /* Include application-specific headers */
 #include "include/types.h"
+#include "impl/vec.h"
+
+/* Options of output in one cache line (a multiple of the 8 lanes) */
+#define PARA_LINE  (64 / sizeof(float))
+
+/* Options per chunk: 2048 x 25 B of inputs and output, about 50 KiB */
+#define PARA_CHUNK 2048
+
+/* Slice [begin, end) of the arrays of args */
+static void slice(args_t* s, const args_t* args, size_t begin, size_t end)
+{
+  s->num_stocks = end - begin;
+  s->sptPrice   = args->sptPrice   + begin;
+  s->strike     = args->strike     + begin;
+  s->rate       = args->rate       + begin;
+  s->volatility = args->volatility + begin;
+  s->otime      = args->otime      + begin;
+  s->otype      = args->otype      + begin;
+  s->output     = args->output     + begin;
+
+  /* Greeks, if any */
+  bool greeks   = (args->delta != NULL);
+  s->delta      = greeks ? (args->delta + begin) : NULL;
+  s->gamma      = greeks ? (args->gamma + begin) : NULL;
+  s->vega       = greeks ? (args->vega  + begin) : NULL;
+  s->theta      = greeks ? (args->theta + begin) : NULL;
+  s->rho        = greeks ? (args->rho   + begin) : NULL;
+
+  /* Market prices, if solving for the implied volatility */
+  s->market     = (args->market != NULL) ? (args->market + begin) : NULL;
+  s->iv_stats   = args->iv_stats;
+}
+
+/* Boundary of range i out of n: the first line of output at or after *
+ * i / n of the options                                                */
+static size_t boundary(const args_t* args, size_t i, size_t n)
+{
+  size_t num_stocks = args->num_stocks;
+
+  if (i == 0) return 0;
+  if (i == n) return num_stocks;
+
+  /* Options before the first line boundary of output */
+  size_t head = ((64 - ((uintptr_t)args->output % 64)) % 64) / sizeof(float);
+  size_t b    = (size_t)(((unsigned __int128)num_stocks * i) / n);
+
+  b = (b <= head) ? head
+                  : head + ((b - head + PARA_LINE - 1) / PARA_LINE) * PARA_LINE;
+
+  return (b < num_stocks) ? b : num_stocks;
+}
+
+/* Kernel of one worker */
+void* worker(void* args)
+{
+  /* Parse the arguments structure */
+  args_t *p_args = (args_t*)args;
+
+  uint64_t t0 = (p_args->worker_ns != NULL) ? timer_clock_ns() : 0;
+
+  args_t chunk;
+  for (size_t i = 0; i < p_args->num_stocks; i += PARA_CHUNK) {
+    size_t end = i + PARA_CHUNK;
+    if (end > p_args->num_stocks) end = p_args->num_stocks;
+
+    slice(&chunk, p_args, i, end);
+    impl_vector(&chunk);
+  }
+
+  if (p_args->worker_ns != NULL) {
+    *(p_args->worker_ns) += timer_clock_ns() - t0;
+  }
+
+  return NULL;
+}
 
 /* Alternative Implementation */
 void* impl_parallel(void* args)
 {
+  /* Get the argument struct */
+  args_t* p_args = (args_t*)args;
+
+  /* Get all the arguments */
+  register       size_t nthreads = p_args->nthreads;
+  register       size_t cpu      = p_args->cpu;
+
+  /* Create all threads */
+  pthread_t tid[nthreads];
+  args_t    targs[nthreads];
+  void*     pargs[nthreads];
+  cpu_set_t cpuset[nthreads];
+
+  for (int i = 0; i < nthreads; i++) {
+    /* Initialize the argument structure */
+    slice(&targs[i], p_args, boundary(p_args, i    , nthreads),
+                             boundary(p_args, i + 1, nthreads));
+
+    targs[i].cpu      = (p_args->cpus != NULL) ? p_args->cpus[i] : (cpu + i);
+    targs[i].nthreads = nthreads;
+    targs[i].cpus     = NULL;
+    targs[i].pool     = NULL;
+
+    targs[i].worker_ns = (p_args->worker_ns != NULL) ? &(p_args->worker_ns[i])
+                                                     : NULL;
+    targs[i].iv_stats  = (p_args->iv_stats  != NULL) ? &(p_args->iv_stats [i])
+                                                     : NULL;
+
+    pargs[i] = (void*)&targs[i];
+  }
+
+  /* Persistent pool: workers are already pinned and waiting */
+  if (p_args->pool != NULL) {
+    pool_run(p_args->pool, worker, pargs, nthreads);
+
+    return NULL;
+  }
+
+  /* Otherwise, spawn (and pin) the threads for this call only */
+  for (int i = 0; i < nthreads; i++) {
+    /* Affinity */
+    CPU_ZERO(&(cpuset[i]));
+    CPU_SET(targs[i].cpu, &(cpuset[i]));
+
+    /* Set affinity */
+    if (i == 0) {
+      tid[i] = pthread_self();
+    } else {
+      int __attribute__((unused)) res = \
+                         pthread_create(&tid[i], NULL, worker, pargs[i]);
+    }
+
+    int __attribute__((unused)) res_affinity = pthread_setaffinity_np(tid[i],
+                                                sizeof(cpuset[i]), &(cpuset[i]));
+  }
+
+  /* Perform one portion of the work */
+  if (nthreads > 0) {
+    worker(pargs[0]);
+  }
+
+  /* Wait for all threads to finish execution */
+  for (int i = 1; i < nthreads; i++) {
+    pthread_join(tid[i], NULL);
+  }
+
+  /* Done */
   return NULL;
 }
@@ -0,0 +1,90 @@
+/* ref.c
+ *
+ * Author: Khalid Al-Hawaj
+ * Date  : 16 Oct. 2026
+ *
+ * Reference implementation, in double precision. The normal CDF comes
+ * from erfc(), N(x) = erfc(-x / sqrt(2)) / 2, which is accurate to the
+ * last bits in both tails. The inputs are the single-precision dataset,
+ * so the reference prices the same options as every implementation; only
+ * the final price is rounded to float. With --greeks, the Greeks are
+ * computed from the textbook formulas, with N'(d2) evaluated on its own.
+ */
+
+/* Standard C includes */
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+
+/* Include common headers */
+#include "common/macros.h"
+#include "common/types.h"
+
+/* Include application-specific headers */
+#include "include/types.h"
+
+/* Standard normal cumulative distribution function */
+static inline double cndf_ref(double x)
+{
+  return 0.5 * erfc(-x * M_SQRT1_2);
+}
+
+void* impl_ref(void* args)
+{
+  /* Get the argument struct */
+  args_t* parsed_args = (args_t*)args;
+
+  /* Get all the arguments */
+  register       size_t num_stocks = parsed_args->num_stocks;
+
+  register const float* sptPrice   = parsed_args->sptPrice  ;
+  register const float* strike     = parsed_args->strike    ;
+  register const float* rate       = parsed_args->rate      ;
+  register const float* volatility = parsed_args->volatility;
+  register const float* otime      = parsed_args->otime     ;
+  register const char * otype      = parsed_args->otype     ;
+  register       float* output     = parsed_args->output    ;
+
+  for (register size_t i = 0; i < num_stocks; i++) {
+    double S = sptPrice[i], K = strike[i], r = rate[i];
+    double v = volatility[i], T = otime[i];
+
+    double v_sqrt_t = v * sqrt(T);
+    double d1       = (log(S / K) + (r + 0.5 * v * v) * T) / v_sqrt_t;
+    double d2       = d1 - v_sqrt_t;
+    double k_disc   = K * exp(-r * T);
+
+    bool   put = (otype[i] == 'P' || otype[i] == 'p');
+
+    double price;
+    if (put) {
+      price = k_disc * cndf_ref(-d2) - S * cndf_ref(-d1);
+    } else {
+      price = S * cndf_ref(d1) - k_disc * cndf_ref(d2);
+    }
+
+    output[i] = (float)price;
+
+    /* Greeks */
+    if (parsed_args->delta != NULL) {
+      double pdf1 = exp(-0.5 * d1 * d1) / sqrt(2.0 * M_PI);
+      double decay = -S * pdf1 * v / (2.0 * sqrt(T));
+
+      if (put) {
+        parsed_args->delta[i] = (float)(cndf_ref(d1) - 1.0);
+        parsed_args->theta[i] = (float)(decay + r * k_disc * cndf_ref(-d2));
+        parsed_args->rho  [i] = (float)(-T * k_disc * cndf_ref(-d2));
+      } else {
+        parsed_args->delta[i] = (float)(cndf_ref(d1));
+        parsed_args->theta[i] = (float)(decay - r * k_disc * cndf_ref(d2));
+        parsed_args->rho  [i] = (float)(T * k_disc * cndf_ref(d2));
+      }
+
+      parsed_args->gamma[i] = (float)(pdf1 / (S * v_sqrt_t));
+      parsed_args->vega [i] = (float)(S * pdf1 * sqrt(T));
+    }
+  }
+
+  /* Done */
+  return NULL;
+}
@@ -8,6 +8,8 @@
 
 /* Standard C includes */
 #include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
 
 /* Include common headers */
 #include "common/macros.h"
@@ -15,9 +17,74 @@
 
 /* Include application-specific headers */
 #include "include/types.h"
+#include "include/price.h"
+#include "include/iv.h"
 
 /* Naive Implementation */
 void* impl_scalar(void* args)
 {
+  /* Get the argument struct */
+  args_t* parsed_args = (args_t*)args;
+
+  /* Get all the arguments */
+  register       size_t num_stocks = parsed_args->num_stocks;
+
+  register const float* sptPrice   = parsed_args->sptPrice  ;
+  register const float* strike     = parsed_args->strike    ;
+  register const float* rate       = parsed_args->rate      ;
+  register const float* volatility = parsed_args->volatility;
+  register const float* otime      = parsed_args->otime     ;
+  register const char * otype      = parsed_args->otype     ;
+  register       float* output     = parsed_args->output    ;
+
+  /* Implied volatility */
+  if (parsed_args->market != NULL) {
+    iv_stats_t st = { 0 };
+
+    for (register size_t i = 0; i < num_stocks; i++) {
+      uint32_t n;
+      bool     ok;
+
+      output[i] = iv_solve(sptPrice[i], strike[i], rate[i], otime[i],
+                           otype[i], parsed_args->market[i], &n, &ok);
+
+      st.iters  += n;
+      st.failed += !ok;
+    }
+
+    if (parsed_args->iv_stats != NULL) {
+      parsed_args->iv_stats->solves += num_stocks;
+      parsed_args->iv_stats->iters  += st.iters;
+      parsed_args->iv_stats->slots  += st.iters;
+      parsed_args->iv_stats->failed += st.failed;
+    }
+
+    return NULL;
+  }
+
+  /* Price only */
+  if (parsed_args->delta == NULL) {
+    for (register size_t i = 0; i < num_stocks; i++) {
+      output[i] = bs_price(sptPrice[i], strike[i], rate[i], volatility[i],
+                           otime[i], otype[i]);
+    }
+
+    return NULL;
+  }
+
+  /* Price and Greeks */
+  for (register size_t i = 0; i < num_stocks; i++) {
+    greeks_t g = bs_greeks(sptPrice[i], strike[i], rate[i], volatility[i],
+                           otime[i], otype[i]);
+
+    output[i]              = g.price;
+    parsed_args->delta[i]  = g.delta;
+    parsed_args->gamma[i]  = g.gamma;
+    parsed_args->vega [i]  = g.vega ;
+    parsed_args->theta[i]  = g.theta;
+    parsed_args->rho  [i]  = g.rho  ;
+  }
+
+  /* Done */
   return NULL;
 }
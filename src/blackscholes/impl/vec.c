@@ -1,13 +1,24 @@
 /* vec.c
  *
- * Author:
- * Date  :
+ * Author: Khalid Al-Hawaj
+ * Date  : 16 Oct. 2026
  *
- *  Description
+ * AVX2 implementation: eight options per iteration with bs_price_ps().
+ * The last num_stocks % 8 options go through the same kernel with masked
+ * loads and stores, so every option is priced with the same arithmetic.
+ * The inactive lanes of the tail compute on zeros and are never stored.
+ * With --greeks, the fused bs_greeks_ps() kernel also writes the Greeks,
+ * and with --implied-vol, iv_solve_ps() solves eight options at a time.
  */
 
 /* Standard C includes */
 #include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+/*  -> SIMD header file  */
+#if defined(__amd64__) || defined(__x86_64__)
+#include <immintrin.h>
+#endif
 
 /* Include common headers */
 #include "common/macros.h"
@@ -15,9 +26,192 @@
 
 /* Include application-specific headers */
 #include "include/types.h"
+#include "include/price.h"
+#include "include/iv.h"
+
+#if defined(__amd64__) || defined(__x86_64__)
+/* Sliding window: the mask of the first n lanes starts at 8 - n */
+static const int32_t mask_window[16] = {
+  -1, -1, -1, -1, -1, -1, -1, -1,
+   0,  0,  0,  0,  0,  0,  0,  0
+};
+#endif
 
 /* Alternative Implementation */
 void* impl_vector(void* args)
 {
+  /* Get the argument struct */
+  args_t* parsed_args = (args_t*)args;
+
+  /* Get all the arguments */
+  register       size_t num_stocks = parsed_args->num_stocks;
+
+  register const float* sptPrice   = parsed_args->sptPrice  ;
+  register const float* strike     = parsed_args->strike    ;
+  register const float* rate       = parsed_args->rate      ;
+  register const float* volatility = parsed_args->volatility;
+  register const float* otime      = parsed_args->otime     ;
+  register const char * otype      = parsed_args->otype     ;
+  register       float* output     = parsed_args->output    ;
+
+  register       size_t i          = 0;
+
+  /* Greeks, if any */
+  register       float* delta      = parsed_args->delta     ;
+  register       float* gamma      = parsed_args->gamma     ;
+  register       float* vega       = parsed_args->vega      ;
+  register       float* theta      = parsed_args->theta     ;
+  register       float* rho        = parsed_args->rho       ;
+
+#if defined(__amd64__) || defined(__x86_64__)
+  /* Implied volatility */
+  if (parsed_args->market != NULL) {
+    const float* market = parsed_args->market;
+    iv_stats_t   st     = { 0 };
+    __m256       all    = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+    for (; i + 8 <= num_stocks; i += 8) {
+      __m256 vol = iv_solve_ps(_mm256_loadu_ps(sptPrice + i),
+                               _mm256_loadu_ps(strike   + i),
+                               _mm256_loadu_ps(rate     + i),
+                               _mm256_loadu_ps(otime    + i),
+                               bs_put_sign(otype + i, 8),
+                               _mm256_loadu_ps(market   + i), all,
+                               &st.iters, &st.slots, &st.failed);
+
+      _mm256_storeu_ps(output + i, vol);
+    }
+
+    if (i < num_stocks) {
+      size_t  n  = num_stocks - i;
+      __m256i vm = _mm256_loadu_si256((const __m256i*)(mask_window + 8 - n));
+
+      __m256 vol = iv_solve_ps(_mm256_maskload_ps(sptPrice + i, vm),
+                               _mm256_maskload_ps(strike   + i, vm),
+                               _mm256_maskload_ps(rate     + i, vm),
+                               _mm256_maskload_ps(otime    + i, vm),
+                               bs_put_sign(otype + i, n),
+                               _mm256_maskload_ps(market   + i, vm),
+                               _mm256_castsi256_ps(vm),
+                               &st.iters, &st.slots, &st.failed);
+
+      _mm256_maskstore_ps(output + i, vm, vol);
+    }
+
+    if (parsed_args->iv_stats != NULL) {
+      parsed_args->iv_stats->solves += num_stocks;
+      parsed_args->iv_stats->iters  += st.iters;
+      parsed_args->iv_stats->slots  += st.slots;
+      parsed_args->iv_stats->failed += st.failed;
+    }
+
+    return NULL;
+  }
+
+  /* Price only */
+  if (delta == NULL) {
+    for (; i + 8 <= num_stocks; i += 8) {
+      __m256 price = bs_price_ps(_mm256_loadu_ps(sptPrice   + i),
+                                 _mm256_loadu_ps(strike     + i),
+                                 _mm256_loadu_ps(rate       + i),
+                                 _mm256_loadu_ps(volatility + i),
+                                 _mm256_loadu_ps(otime      + i),
+                                 bs_put_sign(otype + i, 8));
+
+      _mm256_storeu_ps(output + i, price);
+    }
+
+    if (i < num_stocks) {
+      size_t  n  = num_stocks - i;
+      __m256i vm = _mm256_loadu_si256((const __m256i*)(mask_window + 8 - n));
+
+      __m256 price = bs_price_ps(_mm256_maskload_ps(sptPrice   + i, vm),
+                                 _mm256_maskload_ps(strike     + i, vm),
+                                 _mm256_maskload_ps(rate       + i, vm),
+                                 _mm256_maskload_ps(volatility + i, vm),
+                                 _mm256_maskload_ps(otime      + i, vm),
+                                 bs_put_sign(otype + i, n));
+
+      _mm256_maskstore_ps(output + i, vm, price);
+    }
+
+    return NULL;
+  }
+
+  /* Price and Greeks */
+  for (; i + 8 <= num_stocks; i += 8) {
+    greeks_ps_t g = bs_greeks_ps(_mm256_loadu_ps(sptPrice   + i),
+                                 _mm256_loadu_ps(strike     + i),
+                                 _mm256_loadu_ps(rate       + i),
+                                 _mm256_loadu_ps(volatility + i),
+                                 _mm256_loadu_ps(otime      + i),
+                                 bs_put_sign(otype + i, 8));
+
+    _mm256_storeu_ps(output + i, g.price);
+    _mm256_storeu_ps(delta  + i, g.delta);
+    _mm256_storeu_ps(gamma  + i, g.gamma);
+    _mm256_storeu_ps(vega   + i, g.vega );
+    _mm256_storeu_ps(theta  + i, g.theta);
+    _mm256_storeu_ps(rho    + i, g.rho  );
+  }
+
+  if (i < num_stocks) {
+    size_t  n  = num_stocks - i;
+    __m256i vm = _mm256_loadu_si256((const __m256i*)(mask_window + 8 - n));
+
+    greeks_ps_t g = bs_greeks_ps(_mm256_maskload_ps(sptPrice   + i, vm),
+                                 _mm256_maskload_ps(strike     + i, vm),
+                                 _mm256_maskload_ps(rate       + i, vm),
+                                 _mm256_maskload_ps(volatility + i, vm),
+                                 _mm256_maskload_ps(otime      + i, vm),
+                                 bs_put_sign(otype + i, n));
+
+    _mm256_maskstore_ps(output + i, vm, g.price);
+    _mm256_maskstore_ps(delta  + i, vm, g.delta);
+    _mm256_maskstore_ps(gamma  + i, vm, g.gamma);
+    _mm256_maskstore_ps(vega   + i, vm, g.vega );
+    _mm256_maskstore_ps(theta  + i, vm, g.theta);
+    _mm256_maskstore_ps(rho    + i, vm, g.rho  );
+  }
+
+  return NULL;
+#endif
+
+  /* Without AVX2, one option at a time */
+  if (parsed_args->market != NULL) {
+    for (; i < num_stocks; i++) {
+      uint32_t n;
+      bool     ok;
+
+      output[i] = iv_solve(sptPrice[i], strike[i], rate[i], otime[i],
+                           otype[i], parsed_args->market[i], &n, &ok);
+
+      if (parsed_args->iv_stats != NULL) {
+        parsed_args->iv_stats->solves += 1;
+        parsed_args->iv_stats->iters  += n;
+        parsed_args->iv_stats->slots  += n;
+        parsed_args->iv_stats->failed += !ok;
+      }
+    }
+  }
+
+  for (; i < num_stocks; i++) {
+    if (delta == NULL) {
+      output[i] = bs_price(sptPrice[i], strike[i], rate[i], volatility[i],
+                           otime[i], otype[i]);
+    } else {
+      greeks_t g = bs_greeks(sptPrice[i], strike[i], rate[i], volatility[i],
+                             otime[i], otype[i]);
+
+      output[i] = g.price;
+      delta [i] = g.delta;
+      gamma [i] = g.gamma;
+      vega  [i] = g.vega ;
+      theta [i] = g.theta;
+      rho   [i] = g.rho  ;
+    }
+  }
+
+  /* Done */
   return NULL;
 }
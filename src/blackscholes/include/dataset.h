@@ -6,12 +6,16 @@
  * This file helps with generation of different datasets.
  * The defined function will take as an input the size of the dataset.
  * Then, the function will replicate a set of pre-calculated dataset in
- * optionData.txt over and over again.
+ * optionData.txt over and over again. The replication is split among
+ * the workers; the result does not depend on how many there are.
  */
 
 #ifndef __INCLUDE_DATASET_H_
 #define __INCLUDE_DATASET_H_
 
+/* Include common headers */
+#include "common/pool.h"
+
 #define __dataset_name(x) ((x == 0? "test"  : \
                            (x == 1? "dev"   : \
                            (x == 2? "small" : \
@@ -42,22 +46,29 @@ optionData_t refDataSet[] = {
 
 const int REF_DATASET_SIZE = sizeof(refDataSet) / sizeof(optionData_t);
 
-void genDataset(args_t* args) {
-  /* Get all needed pointers */
-  size_t num_stocks = args->num_stocks;
+/* One worker's range of options; the position in the reference   *
+ * dataset is carried along instead of taking a modulo per element. */
+typedef struct {
+  args_t* args;
+  size_t  lo;
+  size_t  hi;
+} genRange_t;
 
-  float* sptPrice   = args->sptPrice  ;
-  float* strike     = args->strike    ;
-  float* rate       = args->rate      ;
-  float* volatility = args->volatility;
-  float* otime      = args->otime     ;
-  char * otype      = args->otype     ;
-  float* ref        = args->output    ;
+void* genDatasetRange(void* range) {
+  genRange_t* r = (genRange_t*)range;
 
-  /* Copy the data from the reference dataset */
-  for (size_t i = 0; i < num_stocks; i++) {
-    size_t ref_i = i % REF_DATASET_SIZE;
+  /* Get all needed pointers */
+  float* sptPrice   = r->args->sptPrice  ;
+  float* strike     = r->args->strike    ;
+  float* rate       = r->args->rate      ;
+  float* volatility = r->args->volatility;
+  float* otime      = r->args->otime     ;
+  char * otype      = r->args->otype     ;
+  float* ref        = r->args->output    ;
 
+  /* Copy the data from the reference dataset */
+  size_t ref_i = r->lo % REF_DATASET_SIZE;
+  for (size_t i = r->lo; i < r->hi; i++) {
     sptPrice[i]   = refDataSet[ref_i].sptPrice;
     strike[i]     = refDataSet[ref_i].strike;
     rate[i]       = refDataSet[ref_i].rate;
@@ -66,7 +77,34 @@ void genDataset(args_t* args) {
     otype[i]      = refDataSet[ref_i].otype;
 
     ref[i]        = refDataSet[ref_i].price;
+
+    if (++ref_i == REF_DATASET_SIZE) ref_i = 0;
+  }
+
+  return NULL;
+}
+
+/* Generate the dataset and the reference output with nworkers workers *
+ * (the pool, or temporary threads pinned to cpus when it is NULL).    */
+void genDataset(args_t* args, pool_t* pool, const int* cpus, int nworkers) {
+  size_t num_stocks = args->num_stocks;
+
+  genRange_t ranges[nworkers];
+  void*      targs [nworkers];
+
+  /* Ranges are multiples of 16 options (a cache line of floats) */
+  size_t per = ((num_stocks / nworkers) + 15) & ~(size_t)15;
+  for (int w = 0; w < nworkers; w++) {
+    size_t lo = (size_t)w * per;
+    size_t hi = (w == nworkers - 1) ? num_stocks : lo + per;
+    if (lo > num_stocks) lo = num_stocks;
+    if (hi > num_stocks) hi = num_stocks;
+
+    ranges[w] = (genRange_t){ .args = args, .lo = lo, .hi = hi };
+    targs[w]  = &ranges[w];
   }
+
+  pool_run_once(pool, cpus, genDatasetRange, targs, nworkers);
 }
 
 #endif //__INCLUDE_DATASET_H_
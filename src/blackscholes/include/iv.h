@@ -0,0 +1,202 @@
+/* iv.h
+ *
+ * Author: Khalid Al-Hawaj
+ * Date  : 16 Oct. 2026
+ *
+ * This file contains the implied-volatility solver (--implied-vol): the
+ * volatility v at which the Black-Scholes price of an option equals its
+ * market price. The price increases with v, so the root is bracketed in
+ * [IV_VOL_MIN, IV_VOL_MAX], and every iteration narrows the bracket with
+ * the sign of price(v) - market.
+ *
+ * The next v is the Newton-Raphson step v - (price(v) - market) / vega;
+ * when the step leaves the bracket (a small vega far from the money), it
+ * is replaced by the midpoint, so the solver falls back to bisection.
+ * It stops when the price is within IV_TOL_PRICE of the market price, or
+ * when the step drops below IV_TOL_VOL, and gives up after IV_MAX_ITERS.
+ * A market price that no volatility in the bracket reaches collapses the
+ * bracket onto IV_VOL_MIN or IV_VOL_MAX with ever smaller steps; a small
+ * step within IV_EDGE of a bound is therefore a failure, not convergence.
+ *
+ * The first guess is the inflection point of the price in v (Manaster
+ * and Koehler), sqrt(2 |ln(S / K) + rT| / T), from which the Newton
+ * iterations converge monotonically. ln(S / K) + rT, sqrt(T) and
+ * K e^(-rT) do not depend on v and are computed once per option; one
+ * iteration then costs one exponential, for N'(d1).
+ *
+ * The AVX2 solver iterates eight options together, until the last one
+ * converges. Converged lanes are masked out of the updates but still
+ * occupy their slot, which is the lane-utilization loss of divergence.
+*/
+
+#ifndef __INCLUDE_IV_H_
+#define __INCLUDE_IV_H_
+
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+/*  -> SIMD header file  */
+#if defined(__amd64__) || defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+/* Include application-specific headers */
+#include "include/price.h"
+
+/* Bracket, tolerances and iteration limit */
+#define IV_VOL_MIN     1e-3f
+#define IV_VOL_MAX     5.0f
+#define IV_VOL_GUESS   0.05f  /* lowest first guess, for options at the money */
+#define IV_TOL_PRICE   1e-5f
+#define IV_TOL_VOL     1e-6f
+#define IV_EDGE        (2.0f * IV_TOL_VOL)  /* a collapse ends this close to a bound */
+#define IV_MAX_ITERS   64
+
+/* First guess */
+static inline float iv_guess(float x, float T)
+{
+  float v = sqrtf(2.0f * fabsf(x) / T);
+
+  return fminf(fmaxf(v, IV_VOL_GUESS), IV_VOL_MAX);
+}
+
+/* Implied volatility of one option; iters gets the iterations, and *
+ * converged whether it stopped before IV_MAX_ITERS, off the bounds  */
+static inline float iv_solve(float S, float K, float r, float T, char otype,
+                             float market, uint32_t* iters, bool* converged)
+{
+  float s      = (otype == 'P' || otype == 'p') ? -1.0f : 1.0f;
+  float sqrt_t = sqrtf(T);
+  float x      = logf(S / K) + r * T;
+  float k_disc = K * expf(-r * T);
+
+  float lo     = IV_VOL_MIN;
+  float hi     = IV_VOL_MAX;
+  float v      = iv_guess(x, T);
+
+  *converged   = false;
+
+  uint32_t n = 0;
+  while (n < IV_MAX_ITERS) {
+    n++;
+
+    /* Price and vega at v */
+    float v_sqrt_t = v * sqrt_t;
+    float d1       = (x + 0.5f * v * v * T) / v_sqrt_t;
+    float d2       = d1 - v_sqrt_t;
+    float pdf1     = INV_SQRT_2PI * expf(-0.5f * d1 * d1);
+    float pdf2     = pdf1 * S / k_disc;
+    float price    = s * (S * cndf_pdf(s * d1, pdf1) - k_disc * cndf_pdf(s * d2, pdf2));
+    float vega     = S * pdf1 * sqrt_t;
+
+    float f        = price - market;
+    if (fabsf(f) <= IV_TOL_PRICE) { *converged = true; break; }
+
+    /* Narrow the bracket, then step */
+    if (f > 0.0f) hi = v; else lo = v;
+
+    float vn = v - f / vega;
+    if (!(vn > lo && vn < hi)) vn = 0.5f * (lo + hi);
+
+    bool small = fabsf(vn - v) <= IV_TOL_VOL;
+    v = vn;
+
+    if (small) {
+      *converged = (v > IV_VOL_MIN + IV_EDGE) && (v < IV_VOL_MAX - IV_EDGE);
+      break;
+    }
+  }
+
+  *iters = n;
+
+  return v;
+}
+
+#if defined(__amd64__) || defined(__x86_64__)
+/* Implied volatility of the active lanes of eight options; sign from *
+ * bs_put_sign(). Adds the option iterations to iters, the slots of  *
+ * the active lanes to slots and the lanes that did not converge (or  *
+ * collapsed onto a bound) to failed.                                  */
+static inline __m256 iv_solve_ps(__m256 S, __m256 K, __m256 r, __m256 T,
+                                 __m256 sign, __m256 market, __m256 active,
+                                 uint64_t* iters, uint64_t* slots,
+                                 uint64_t* failed)
+{
+  __m256 neg0   = _mm256_set1_ps(-0.0f);
+  __m256 half   = _mm256_set1_ps(0.5f);
+
+  __m256 sqrt_t = _mm256_sqrt_ps(T);
+  __m256 x      = _mm256_add_ps(_mm256_log_ps(_mm256_div_ps(S, K)),
+                                _mm256_mul_ps(r, T));
+  __m256 k_disc = _mm256_mul_ps(K, _mm256_exp_ps(
+                    _mm256_xor_ps(_mm256_mul_ps(r, T), neg0)));
+
+  __m256 lo     = _mm256_set1_ps(IV_VOL_MIN);
+  __m256 hi     = _mm256_set1_ps(IV_VOL_MAX);
+
+  /* First guess */
+  __m256 v      = _mm256_sqrt_ps(_mm256_div_ps(
+                    _mm256_add_ps(_mm256_andnot_ps(neg0, x),
+                                  _mm256_andnot_ps(neg0, x)), T));
+  v = _mm256_min_ps(_mm256_max_ps(v, _mm256_set1_ps(IV_VOL_GUESS)), hi);
+
+  /* Lanes without an option (the tail) are not counted as slots */
+  int mask  = _mm256_movemask_ps(active);
+  int lanes = __builtin_popcount(mask);
+  for (int n = 0; (n < IV_MAX_ITERS) && (mask != 0); n++) {
+    *slots += lanes;
+    *iters += __builtin_popcount(mask);
+
+    /* Price and vega at v */
+    __m256 v_sqrt_t = _mm256_mul_ps(v, sqrt_t);
+    __m256 d1       = _mm256_div_ps(_mm256_add_ps(x,
+                        _mm256_mul_ps(_mm256_mul_ps(half, _mm256_mul_ps(v, v)), T)),
+                        v_sqrt_t);
+    __m256 d2       = _mm256_sub_ps(d1, v_sqrt_t);
+    __m256 pdf1     = npdf_ps(d1);
+    __m256 pdf2     = _mm256_div_ps(_mm256_mul_ps(pdf1, S), k_disc);
+    __m256 n1       = cndf_pdf_ps(_mm256_xor_ps(d1, sign), pdf1);
+    __m256 n2       = cndf_pdf_ps(_mm256_xor_ps(d2, sign), pdf2);
+    __m256 price    = _mm256_xor_ps(_mm256_sub_ps(_mm256_mul_ps(S, n1),
+                                                  _mm256_mul_ps(k_disc, n2)), sign);
+    __m256 vega     = _mm256_mul_ps(_mm256_mul_ps(S, pdf1), sqrt_t);
+
+    __m256 f        = _mm256_sub_ps(price, market);
+    __m256 done     = _mm256_cmp_ps(_mm256_andnot_ps(neg0, f),
+                                    _mm256_set1_ps(IV_TOL_PRICE), _CMP_LE_OQ);
+
+    /* Narrow the bracket, then step */
+    __m256 above    = _mm256_cmp_ps(f, _mm256_setzero_ps(), _CMP_GT_OQ);
+    hi = _mm256_blendv_ps(hi, v, _mm256_and_ps(active, above));
+    lo = _mm256_blendv_ps(lo, v, _mm256_andnot_ps(above, active));
+
+    __m256 vn       = _mm256_sub_ps(v, _mm256_div_ps(f, vega));
+    __m256 inside   = _mm256_and_ps(_mm256_cmp_ps(vn, lo, _CMP_GT_OQ),
+                                    _mm256_cmp_ps(vn, hi, _CMP_LT_OQ));
+    vn = _mm256_blendv_ps(_mm256_mul_ps(half, _mm256_add_ps(lo, hi)), vn, inside);
+
+    __m256 small    = _mm256_cmp_ps(_mm256_andnot_ps(neg0, _mm256_sub_ps(vn, v)),
+                                    _mm256_set1_ps(IV_TOL_VOL), _CMP_LE_OQ);
+
+    /* Lanes that stop on a small step at a bound did not converge */
+    __m256 interior = _mm256_and_ps(
+                        _mm256_cmp_ps(vn, _mm256_set1_ps(IV_VOL_MIN + IV_EDGE), _CMP_GT_OQ),
+                        _mm256_cmp_ps(vn, _mm256_set1_ps(IV_VOL_MAX - IV_EDGE), _CMP_LT_OQ));
+    __m256 stalled  = _mm256_andnot_ps(done, _mm256_and_ps(small, active));
+    *failed += __builtin_popcount(_mm256_movemask_ps(
+                                    _mm256_andnot_ps(interior, stalled)));
+
+    /* Active lanes that are not within the price tolerance take the step */
+    v      = _mm256_blendv_ps(v, vn, _mm256_andnot_ps(done, active));
+    active = _mm256_andnot_ps(_mm256_or_ps(done, small), active);
+    mask   = _mm256_movemask_ps(active);
+  }
+
+  *failed += __builtin_popcount(mask);
+
+  return v;
+}
+#endif
+
+#endif //__INCLUDE_IV_H_
@@ -0,0 +1,279 @@
+/* price.h
+ *
+ * Author: Khalid Al-Hawaj
+ * Date  : 16 Oct. 2026
+ *
+ * This file contains the scalar Black-Scholes pricing of one European
+ * option in single precision, shared by the implementations (and used
+ * for the elements the vectorized code leaves over).
+ *
+ *   d1    = (ln(S / K) + (r + v^2 / 2) T) / (v sqrt(T))
+ *   d2    = d1 - v sqrt(T)
+ *   call  = S N(d1)  - K e^(-rT) N(d2)
+ *   put   = K e^(-rT) N(-d2) - S N(-d1)
+ *
+ * N() is the standard normal CDF, from the polynomial approximation of
+ * Abramowitz and Stegun (26.2.17, absolute error below 7.5e-8). The put
+ * evaluates N() at -d1 and -d2 instead of using 1 - N(), which would
+ * lose the small prices of deep out-of-the-money puts to cancellation.
+ * otype is 'P' (or 'p') for a put and anything else for a call.
+ *
+ * The approximation scales a polynomial by the density N'(x), and the
+ * densities at d1 and d2 are related by
+ *
+ *   N'(d2) = N'(d1) S / (K e^(-rT))
+ *
+ * so every kernel computes one exponential for both, and the price costs
+ * two exponentials (with the one of e^(-rT)) instead of three.
+ *
+ * The AVX2 versions price eight options at once with the same formulas,
+ * with logarithm and exponential from common/vmath.h. They select call or
+ * put without a branch: a put is the negated call formula at -d1 and -d2,
+ *
+ *   put   = -(S N(-d1) - K e^(-rT) N(-d2))
+ *
+ * so the put lanes only flip the sign bit of d1, d2 and the price.
+ *
+ * The Greeks are computed together with the price, from the same d1, d2,
+ * K e^(-rT) and N'(d1); with s = 1 for a call and -1 for a put,
+ *
+ *   delta = s N(s d1)
+ *   gamma = N'(d1) / (S v sqrt(T))
+ *   vega  = S N'(d1) sqrt(T)
+ *   theta = -S N'(d1) v / (2 sqrt(T)) - s r K e^(-rT) N(s d2)
+ *   rho   = s T K e^(-rT) N(s d2)
+ *
+ * per unit of volatility, rate and year (theta is the decay as calendar
+ * time passes). They reuse N'(d1), so they cost no exponential over the
+ * price.
+*/
+
+#ifndef __INCLUDE_PRICE_H_
+#define __INCLUDE_PRICE_H_
+
+/* Standard C includes */
+#include <stddef.h>
+#include <math.h>
+/*  -> SIMD header file  */
+#if defined(__amd64__) || defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+/* Include common headers */
+#include "common/vmath.h"
+
+/* Abramowitz and Stegun 26.2.17 */
+#define CNDF_P   0.2316419f
+#define CNDF_B1  0.319381530f
+#define CNDF_B2 -0.356563782f
+#define CNDF_B3  1.781477937f
+#define CNDF_B4 -1.821255978f
+#define CNDF_B5  1.330274429f
+
+/* 1 / sqrt(2 pi) */
+#define INV_SQRT_2PI 0.39894228040143267794f
+
+/* Standard normal cumulative distribution function, given the density *
+ * pdf = N'(x)                                                          */
+static inline float cndf_pdf(float x, float pdf)
+{
+  float ax   = fabsf(x);
+  float k    = 1.0f / (1.0f + CNDF_P * ax);
+  float poly = k * (CNDF_B1 + k * (CNDF_B2 + k * (CNDF_B3 +
+               k * (CNDF_B4 + k *  CNDF_B5))));
+
+  /* Upper tail, N(-|x|) */
+  float tail = pdf * poly;
+
+  return (x < 0.0f) ? tail : (1.0f - tail);
+}
+
+/* Price of one option */
+static inline float bs_price(float S, float K, float r, float v, float T,
+                             char otype)
+{
+  float v_sqrt_t = v * sqrtf(T);
+  float d1       = (logf(S / K) + (r + 0.5f * v * v) * T) / v_sqrt_t;
+  float d2       = d1 - v_sqrt_t;
+  float k_disc   = K * expf(-r * T);
+
+  float s        = (otype == 'P' || otype == 'p') ? -1.0f : 1.0f;
+
+  /* Densities at d1 and d2 */
+  float pdf1     = INV_SQRT_2PI * expf(-0.5f * d1 * d1);
+  float pdf2     = pdf1 * S / k_disc;
+
+  return s * (S * cndf_pdf(s * d1, pdf1) - k_disc * cndf_pdf(s * d2, pdf2));
+}
+
+/* Price and Greeks of one option */
+typedef struct {
+  float price;
+  float delta;
+  float gamma;
+  float vega ;
+  float theta;
+  float rho  ;
+} greeks_t;
+
+static inline greeks_t bs_greeks(float S, float K, float r, float v, float T,
+                                 char otype)
+{
+  float sqrt_t   = sqrtf(T);
+  float v_sqrt_t = v * sqrt_t;
+  float d1       = (logf(S / K) + (r + 0.5f * v * v) * T) / v_sqrt_t;
+  float d2       = d1 - v_sqrt_t;
+  float k_disc   = K * expf(-r * T);
+
+  float s        = (otype == 'P' || otype == 'p') ? -1.0f : 1.0f;
+
+  /* Densities at d1 and d2 */
+  float pdf1     = INV_SQRT_2PI * expf(-0.5f * d1 * d1);
+  float pdf2     = pdf1 * S / k_disc;
+
+  float n1       = cndf_pdf(s * d1, pdf1);
+  float n2       = cndf_pdf(s * d2, pdf2);
+  float kd_n2    = k_disc * n2;
+
+  greeks_t g;
+  g.price = s * (S * n1 - kd_n2);
+  g.delta = s * n1;
+  g.gamma = pdf1 / (S * v_sqrt_t);
+  g.vega  = S * pdf1 * sqrt_t;
+  g.theta = -(S * pdf1 * v) / (2.0f * sqrt_t) - s * r * kd_n2;
+  g.rho   = s * T * kd_n2;
+
+  return g;
+}
+
+#if defined(__amd64__) || defined(__x86_64__)
+/* Standard normal cumulative distribution function, eight lanes, given *
+ * the density pdf = N'(x)                                              */
+static inline __m256 cndf_pdf_ps(__m256 x, __m256 pdf)
+{
+  __m256 one  = _mm256_set1_ps(1.0f);
+  __m256 ax   = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x);
+  __m256 k    = _mm256_div_ps(one, _mm256_add_ps(one,
+                  _mm256_mul_ps(_mm256_set1_ps(CNDF_P), ax)));
+
+  __m256 poly = _mm256_set1_ps(CNDF_B5);
+  poly = _mm256_add_ps(_mm256_mul_ps(poly, k), _mm256_set1_ps(CNDF_B4));
+  poly = _mm256_add_ps(_mm256_mul_ps(poly, k), _mm256_set1_ps(CNDF_B3));
+  poly = _mm256_add_ps(_mm256_mul_ps(poly, k), _mm256_set1_ps(CNDF_B2));
+  poly = _mm256_add_ps(_mm256_mul_ps(poly, k), _mm256_set1_ps(CNDF_B1));
+  poly = _mm256_mul_ps(poly, k);
+
+  /* Upper tail, N(-|x|) */
+  __m256 tail = _mm256_mul_ps(pdf, poly);
+
+  return _mm256_blendv_ps(_mm256_sub_ps(one, tail), tail,
+                          _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_LT_OQ));
+}
+
+/* Standard normal density, eight lanes */
+static inline __m256 npdf_ps(__m256 x)
+{
+  return _mm256_mul_ps(_mm256_set1_ps(INV_SQRT_2PI),
+           _mm256_exp_ps(_mm256_mul_ps(_mm256_set1_ps(-0.5f),
+                                       _mm256_mul_ps(x, x))));
+}
+
+/* The sign bit in the put lanes of n <= 8 option types, zero elsewhere */
+static inline __m256 bs_put_sign(const char* otype, size_t n)
+{
+  long long bytes = 0;
+
+  if (n >= 8) {
+    __builtin_memcpy(&bytes, otype, 8);
+  } else {
+    __builtin_memcpy(&bytes, otype, n);
+  }
+
+  /* 'p' | 0x20 == 'P' | 0x20 */
+  __m256i t = _mm256_cvtepu8_epi32(_mm_cvtsi64_si128(bytes));
+  t = _mm256_or_si256(t, _mm256_set1_epi32(0x20));
+  t = _mm256_cmpeq_epi32(t, _mm256_set1_epi32('p'));
+
+  return _mm256_and_ps(_mm256_castsi256_ps(t), _mm256_set1_ps(-0.0f));
+}
+
+/* Price of eight options; sign from bs_put_sign() */
+static inline __m256 bs_price_ps(__m256 S, __m256 K, __m256 r, __m256 v,
+                                 __m256 T, __m256 sign)
+{
+  __m256 v_sqrt_t = _mm256_mul_ps(v, _mm256_sqrt_ps(T));
+  __m256 d1       = _mm256_div_ps(
+                      _mm256_add_ps(_mm256_log_ps(_mm256_div_ps(S, K)),
+                        _mm256_mul_ps(_mm256_add_ps(r,
+                          _mm256_mul_ps(_mm256_set1_ps(0.5f),
+                                        _mm256_mul_ps(v, v))), T)),
+                      v_sqrt_t);
+  __m256 d2       = _mm256_sub_ps(d1, v_sqrt_t);
+  __m256 k_disc   = _mm256_mul_ps(K, _mm256_exp_ps(
+                      _mm256_xor_ps(_mm256_mul_ps(r, T),
+                                    _mm256_set1_ps(-0.0f))));
+
+  /* Densities at d1 and d2 */
+  __m256 pdf1     = npdf_ps(d1);
+  __m256 pdf2     = _mm256_div_ps(_mm256_mul_ps(pdf1, S), k_disc);
+
+  /* Call at (d1, d2), or the negated call at (-d1, -d2) */
+  __m256 n1       = cndf_pdf_ps(_mm256_xor_ps(d1, sign), pdf1);
+  __m256 n2       = cndf_pdf_ps(_mm256_xor_ps(d2, sign), pdf2);
+
+  return _mm256_xor_ps(_mm256_sub_ps(_mm256_mul_ps(S, n1),
+                                     _mm256_mul_ps(k_disc, n2)), sign);
+}
+
+/* Price and Greeks of eight options; sign from bs_put_sign() */
+typedef struct {
+  __m256 price;
+  __m256 delta;
+  __m256 gamma;
+  __m256 vega ;
+  __m256 theta;
+  __m256 rho  ;
+} greeks_ps_t;
+
+static inline greeks_ps_t bs_greeks_ps(__m256 S, __m256 K, __m256 r,
+                                       __m256 v, __m256 T, __m256 sign)
+{
+  __m256 sqrt_t   = _mm256_sqrt_ps(T);
+  __m256 v_sqrt_t = _mm256_mul_ps(v, sqrt_t);
+  __m256 d1       = _mm256_div_ps(
+                      _mm256_add_ps(_mm256_log_ps(_mm256_div_ps(S, K)),
+                        _mm256_mul_ps(_mm256_add_ps(r,
+                          _mm256_mul_ps(_mm256_set1_ps(0.5f),
+                                        _mm256_mul_ps(v, v))), T)),
+                      v_sqrt_t);
+  __m256 d2       = _mm256_sub_ps(d1, v_sqrt_t);
+  __m256 k_disc   = _mm256_mul_ps(K, _mm256_exp_ps(
+                      _mm256_xor_ps(_mm256_mul_ps(r, T),
+                                    _mm256_set1_ps(-0.0f))));
+
+  /* Densities at d1 and d2 */
+  __m256 pdf1     = npdf_ps(d1);
+  __m256 pdf2     = _mm256_div_ps(_mm256_mul_ps(pdf1, S), k_disc);
+
+  __m256 n1       = cndf_pdf_ps(_mm256_xor_ps(d1, sign), pdf1);
+  __m256 n2       = cndf_pdf_ps(_mm256_xor_ps(d2, sign), pdf2);
+  __m256 kd_n2    = _mm256_mul_ps(k_disc, n2);
+  __m256 s_pdf1   = _mm256_mul_ps(S, pdf1);
+
+  greeks_ps_t g;
+  g.price = _mm256_xor_ps(_mm256_sub_ps(_mm256_mul_ps(S, n1), kd_n2), sign);
+  g.delta = _mm256_xor_ps(n1, sign);
+  g.gamma = _mm256_div_ps(pdf1, _mm256_mul_ps(S, v_sqrt_t));
+  g.vega  = _mm256_mul_ps(s_pdf1, sqrt_t);
+  g.theta = _mm256_sub_ps(
+              _mm256_xor_ps(_mm256_div_ps(_mm256_mul_ps(s_pdf1, v),
+                              _mm256_add_ps(sqrt_t, sqrt_t)),
+                            _mm256_set1_ps(-0.0f)),
+              _mm256_xor_ps(_mm256_mul_ps(r, kd_n2), sign));
+  g.rho   = _mm256_xor_ps(_mm256_mul_ps(T, kd_n2), sign);
+
+  return g;
+}
+#endif
+
+#endif //__INCLUDE_PRICE_H_
@@ -9,6 +9,14 @@
 #ifndef __INCLUDE_TYPES_H_
 #define __INCLUDE_TYPES_H_
 
+/* Counters of the implied-volatility solver (--implied-vol) */
+typedef struct {
+  uint64_t solves;  /* options solved                                */
+  uint64_t iters;   /* iterations, summed over the options           */
+  uint64_t slots;   /* lane slots issued (= iters, if not vectorized) */
+  uint64_t failed;  /* options that did not converge                  */
+} iv_stats_t;
+
 typedef struct {
   size_t num_stocks;
 
@@ -20,8 +28,34 @@ typedef struct {
   char * otype     ;
   float* output    ;
 
+  /* Greeks of every option (--greeks), or all NULL to price only */
+  float* delta;
+  float* gamma;
+  float* vega ;
+  float* theta;
+  float* rho  ;
+
+  /* Market prices to solve for the implied volatility of every option *
+   * into output (--implied-vol), or NULL to price                      */
+  const float* market;
+
+  /* Solver counters, accumulated over invocations; one slot per *
+   * thread, or NULL when not recorded.                           */
+  iv_stats_t* iv_stats;
+
   int    cpu;
   int    nthreads;
+
+  /* Worker i is pinned to cpus[i] (--placement), or NULL */
+  const int* cpus;
+
+  /* Per-worker compute time in ns, accumulated over invocations; *
+   * one slot per thread, or NULL when not recorded.               */
+  uint64_t* worker_ns;
+
+  /* Persistent worker pool (common/pool.h), or NULL to spawn the *
+   * threads on every invocation.                                  */
+  struct pool* pool;
 } args_t;
 
 #endif //__INCLUDE_TYPES_H_
@@ -17,9 +17,12 @@
  * record the runtime of _each_ invocation through the following Linux
  * API:
  *    clock_gettime(), with the clk_id set to CLOCK_MONOTONIC
- * Then, the file will calculate the standard deviation and calculate
- * an outlier-free average by excluding runtimes that are larger than
- * 2 standard deviation of the original average.
+ * or, with "--timer tsc", the serialized time-stamp counter (see
+ * common/timer.h).
+ * Then, the file will report robust statistics (min, median and its
+ * bootstrap confidence interval, tail percentiles and MAD) alongside
+ * an outlier-free average that excludes runtimes more than nstdevs
+ * standard deviations away from the average (see common/stats.h).
  */
 
 /* Set features         */
@@ -43,6 +46,7 @@
 #include <errno.h>
 
 /* Include all implementations declarations */
+#include "impl/ref.h"
 #include "impl/scalar.h"
 #include "impl/vec.h"
 #include "impl/para.h"
@@ -50,13 +54,177 @@
 /* Include common headers */
 #include "common/types.h"
 #include "common/macros.h"
+#include "common/perf.h"
+#include "common/timer.h"
+#include "common/stats.h"
+#include "common/impl.h"
+#include "common/arena.h"
+#include "common/align.h"
+#include "common/faults.h"
+#include "common/topo.h"
+#include "common/pool.h"
+#include "common/bench.h"
 
 /* Include application-specific headers */
 #include "include/types.h"
+#include "include/price.h"
 
 /* Dataset */
 #include "include/dataset.h"
 
+/* The SoA arrays, in --align order; the output comes last */
+#define SOA_NARRAYS 7
+
+static const char* const soa_names[SOA_NARRAYS] = {
+  "sptPrice", "strike", "rate", "volatility", "otime", "otype", "output"
+};
+
+/* Point the arrays of args at their new offsets; the inputs slide *
+ * their data along, the output is rewritten by every run anyway.  */
+static void soa_place(args_t* args, byte* const* bufs, const size_t* lens,
+                      size_t* cur, const size_t* offs)
+{
+  byte* p[SOA_NARRAYS];
+  for (int b = 0; b < SOA_NARRAYS; b++) {
+    size_t len = (b < SOA_NARRAYS - 1) ? lens[b] : 0;
+    p[b]   = align_move(align_base(bufs[b]), cur[b], offs[b], len);
+    cur[b] = offs[b];
+  }
+
+  args->sptPrice   = (float*)p[0];
+  args->strike     = (float*)p[1];
+  args->rate       = (float*)p[2];
+  args->volatility = (float*)p[3];
+  args->otime      = (float*)p[4];
+  args->otype      = (char *)p[5];
+  args->output     = (float*)p[6];
+}
+
+/* The Greeks of --greeks */
+#define NGREEKS 5
+
+/* Point the Greeks of args at g, or at nothing (price only) if NULL */
+static void greeks_set(args_t* args, float* const* g)
+{
+  args->delta = (g != NULL) ? g[0] : NULL;
+  args->gamma = (g != NULL) ? g[1] : NULL;
+  args->vega  = (g != NULL) ? g[2] : NULL;
+  args->theta = (g != NULL) ? g[3] : NULL;
+  args->rho   = (g != NULL) ? g[4] : NULL;
+}
+
+/* The Greeks match the reference within 1e-3, relative to the larger *
+ * of 1 and the reference, and their guards are intact                */
+static bool greeks_match(float* const* ref, float* const* out, size_t n)
+{
+  for (int g = 0; g < NGREEKS; g++) {
+    for (size_t i = 0; i < n; i++) {
+      float tol = 1e-3f * fmaxf(1.0f, fabsf(ref[g][i]));
+      if (!(fabsf(ref[g][i] - out[g][i]) <= tol)) return false;
+    }
+
+    if (!__CHECK_GUARD(out[g], n * sizeof(float))) return false;
+  }
+
+  return true;
+}
+
+/* Every implied volatility is within 1e-3 of the volatility of the *
+ * dataset, or prices the option within 1e-4 of its market price     */
+static bool iv_match(const args_t* args, const float* vol, size_t n)
+{
+  for (size_t i = 0; i < n; i++) {
+    if (fabsf(vol[i] - args->volatility[i]) <= 1e-3f) continue;
+
+    float price = bs_price(args->sptPrice[i], args->strike[i], args->rate[i],
+                           vol[i], args->otime[i], args->otype[i]);
+    if (!(fabsf(price - args->market[i]) <= 1e-4f)) return false;
+  }
+
+  return true;
+}
+
+/* Output of the measured runs, for the callbacks of common/bench.h */
+typedef struct {
+  const args_t* args;
+  const float*  ref;
+
+  /* The Greeks of --greeks and their reference */
+  float* const* greek;
+  float* const* greek_ref;
+} output_t;
+
+/* Clear the output of args (and its Greeks) and set the guards */
+static void output_reset(void* ctx)
+{
+  const output_t* o    = (output_t*)ctx;
+  const args_t*   args = o->args;
+  size_t          n    = args->num_stocks;
+
+  for (size_t i = 0; i < n; i++) {
+    args->output[i] = 0.0f;
+  }
+  __SET_GUARD(args->output, n * sizeof(float));
+
+  if (args->delta != NULL) {
+    for (int g = 0; g < NGREEKS; g++) {
+      for (size_t i = 0; i < n; i++) {
+        o->greek[g][i] = 0.0f;
+      }
+      __SET_GUARD(o->greek[g], n * sizeof(float));
+    }
+  }
+}
+
+/* The output of args matches the reference (the implied volatilities *
+ * with --implied-vol, the Greeks too with --greeks) and the guards    *
+ * are intact                                                           */
+static bool output_check(void* ctx)
+{
+  const output_t* o    = (output_t*)ctx;
+  const args_t*   args = o->args;
+  size_t          n    = args->num_stocks;
+
+  bool match = (args->market != NULL) ? iv_match(args, args->output, n)
+                                      : __CHECK_FLOAT_MATCH(o->ref, args->output, n, 1e-4);
+  match = match && __CHECK_GUARD(args->output, n * sizeof(float));
+
+  if (args->delta != NULL) {
+    match = match && greeks_match(o->greek_ref, o->greek, n);
+  }
+
+  return match;
+}
+
+/* Thread count and per-worker compute times of args */
+static void threads_set(void* args, int nthreads, uint64_t* worker_ns)
+{
+  ((args_t*)args)->nthreads  = nthreads;
+  ((args_t*)args)->worker_ns = worker_ns;
+}
+
+/* Groups of the offset sweep: the inputs, and the output */
+static const char* const group_names[2] = { "inputs", "output" };
+
+typedef struct {
+  args_t*       args;
+  byte* const*  bufs;
+  const size_t* lens;
+  size_t        cur[SOA_NARRAYS];
+} groups_t;
+
+/* Point the inputs of args at offs[0] and the output at offs[1] */
+static void groups_place(void* ctx, const size_t* offs)
+{
+  groups_t* p = (groups_t*)ctx;
+
+  size_t to[SOA_NARRAYS];
+  for (int b = 0; b < SOA_NARRAYS; b++) {
+    to[b] = (b < SOA_NARRAYS - 1) ? offs[0] : offs[1];
+  }
+  soa_place(p->args, p->bufs, p->lens, p->cur, to);
+}
+
 int main(int argc, char** argv)
 {
   /* Set the buffer for printf to NULL */
@@ -66,43 +234,107 @@ int main(int argc, char** argv)
   int nthreads = 1;
   int cpu      = 0;
 
+  place_t placement = PLACE_COMPACT;
+  pages_t pages     = PAGES_4K;
+
+  int threads_min = 0;
+  int threads_max = 0;
+
+  bool spawn    = false;
+  bool prefault = false;
+  bool greeks   = false;
+  bool implied  = false;
+
   int nruns    = 128;
   int nstdevs  = 3;
 
+  int nreps         = 0;
+  int min_sample_us = 50;
+  int warmup_ms     = 500;
+
   /* Data */
   int dataset      = 0;
   int dataset_size = 0;
 
+  /* Byte offsets of the SoA arrays from a 4 KiB boundary */
+  size_t align[SOA_NARRAYS] = { 0 };
+
+  /* Offset sweep; the inputs and the output take each of the offsets */
+  size_t offs[ALIGN_MAX_OFFS];
+  int    noffs = 0;
+
   /* Parse arguments */
-  /* Function pointers */
-  void* (*impl_scalar_ptr  )(void* args) = impl_scalar;
-  void* (*impl_vector_ptr  )(void* args) = impl_vector;
-  void* (*impl_parallel_ptr)(void* args) = impl_parallel;
+  /* Implementations */
+  const impl_t impls[] = {
+    { "scalar", "scalar"      , impl_scalar   },
+    { "vec"   , "vectorized"  , impl_vector   },
+    { "para"  , "parallelized", impl_parallel },
+  };
+  const int nimpls = sizeof(impls) / sizeof(impl_t);
 
   /* Chosen */
-  void* (*impl)(void* args) = NULL;
-  const char* impl_str      = NULL;
+  int  sel[IMPL_MAX];
+  int  nsel = 0;
+
+  /* Interleaved A/B comparison */
+  int  ab_sel[IMPL_MAX];
+  int  nab  = 0;
 
   bool parse_args_err       = false;
 
+  /* Performance counters */
+  perf_group_t perf;
+  perf_init(&perf);
+
+  /* Timer */
+  timer_cfg_t timer;
+  timer_init(&timer);
+
   bool help = false;
   for (int i = 1; i < argc; i++) {
     /* Implementations */
     if (strcmp(argv[i], "-i") == 0 || strcmp(argv[i], "--impl") == 0) {
       assert (++i < argc);
-      if (strcmp(argv[i], "scalar") == 0) {
-        impl = impl_scalar_ptr  ; impl_str = "scalar";
-      } else if (strcmp(argv[i], "vec"  ) == 0) {
-        impl = impl_vector_ptr  ; impl_str = "vectorized"  ;
-      } else if (strcmp(argv[i], "para" ) == 0) {
-        impl = impl_parallel_ptr; impl_str = "parallelized";
-      } else {
-        impl = NULL             ; impl_str = "unknown"     ;
+      char bad[64];
+      if (!impl_parse(impls, nimpls, argv[i], sel, &nsel, bad, sizeof(bad))) {
+        printf("\n");
+        printf("ERROR: Unknown \"%s\" implementation.\n", bad);
+
+        parse_args_err = true;
+      }
+
+      continue;
+    }
 
+    if (strcmp(argv[i], "--align") == 0) {
+      assert (++i < argc);
+      int n;
+      if (!align_parse(argv[i], sizeof(float), align, SOA_NARRAYS, &n) ||
+          (n != 1 && n != 2 && n != SOA_NARRAYS)) {
         printf("\n");
-        printf("ERROR: Unknown \"%s\" implementation.\n", argv[i]);
+        printf("ERROR: Invalid offsets \"%s\" (expected 1, 2 or %d multiples of %zu below %d)\n",
+                                       argv[i], SOA_NARRAYS, sizeof(float), ALIGN_PAGE);
 
         parse_args_err = true;
+      } else if (n < SOA_NARRAYS) {
+        /* One for all arrays, or one for the inputs and one for the output */
+        size_t in = align[0], out = align[n - 1];
+        for (int b = 0; b < SOA_NARRAYS - 1; b++) align[b] = in;
+        align[SOA_NARRAYS - 1] = out;
+      }
+
+      continue;
+    }
+
+    if (strcmp(argv[i], "--offset-sweep") == 0) {
+      assert (++i < argc);
+      if (!align_parse(argv[i], sizeof(float), offs, ALIGN_MAX_OFFS, &noffs)) {
+        printf("\n");
+        printf("ERROR: Invalid offset sweep \"%s\" (expected multiples of %zu below %d)\n",
+                                                      argv[i], sizeof(float), ALIGN_PAGE);
+
+        noffs          = 0;
+        parse_args_err = true;
       }
 
       continue;
@@ -145,6 +377,73 @@ int main(int argc, char** argv)
       continue;
     }
 
+    if (strcmp(argv[i], "--reps") == 0) {
+      assert (++i < argc);
+      nreps = atoi(argv[i]);
+
+      continue;
+    }
+
+    if (strcmp(argv[i], "--min-sample-us") == 0) {
+      assert (++i < argc);
+      min_sample_us = atoi(argv[i]);
+
+      continue;
+    }
+
+    if (strcmp(argv[i], "--warmup-ms") == 0) {
+      assert (++i < argc);
+      warmup_ms = atoi(argv[i]);
+
+      continue;
+    }
+
+    /* Interleaved A/B comparison */
+    if (strcmp(argv[i], "--ab") == 0) {
+      assert (++i < argc);
+      char bad[64];
+      if (!impl_parse(impls, nimpls, argv[i], ab_sel, &nab, bad, sizeof(bad))) {
+        printf("\n");
+        printf("ERROR: Unknown \"%s\" implementation.\n", bad);
+
+        parse_args_err = true;
+      } else if (nab < 2) {
+        printf("\n");
+        printf("ERROR: --ab needs at least two implementations.\n");
+
+        parse_args_err = true;
+      }
+
+      continue;
+    }
+
+    /* Timer source */
+    if (strcmp(argv[i], "--timer") == 0) {
+      assert (++i < argc);
+      if (!timer_parse(&timer, argv[i])) {
+        printf("\n");
+        printf("ERROR: Unknown timer \"%s\"\n", argv[i]);
+
+        parse_args_err = true;
+      }
+
+      continue;
+    }
+
+    /* Performance counters */
+    if (strcmp(argv[i], "--counters") == 0) {
+      assert (++i < argc);
+      char bad[64];
+      if (!perf_parse(&perf, argv[i], bad, sizeof(bad))) {
+        printf("\n");
+        printf("ERROR: Unknown performance counter \"%s\"\n", bad);
+
+        parse_args_err = true;
+      }
+
+      continue;
+    }
+
     /* Parallelization */
     if (strcmp(argv[i], "-n") == 0 || strcmp(argv[i], "--nthreads") == 0) {
       assert (++i < argc);
@@ -153,6 +452,72 @@ int main(int argc, char** argv)
       continue;
     }
 
+    if (strcmp(argv[i], "--threads-sweep") == 0) {
+      assert (++i < argc);
+      int n = sscanf(argv[i], "%d:%d", &threads_min, &threads_max);
+      if (n == 1) {
+        threads_max = threads_min;
+        threads_min = 1;
+      }
+      if (n < 1 || threads_min < 1 || threads_max < threads_min) {
+        printf("\n");
+        printf("ERROR: Invalid thread sweep \"%s\" (expected min:max)\n", argv[i]);
+
+        threads_max    = 0;
+        parse_args_err = true;
+      }
+
+      continue;
+    }
+
+    if (strcmp(argv[i], "--prefault") == 0) {
+      prefault = true;
+
+      continue;
+    }
+
+    if (strcmp(argv[i], "--spawn") == 0) {
+      spawn = true;
+
+      continue;
+    }
+
+    if (strcmp(argv[i], "--greeks") == 0) {
+      greeks = true;
+
+      continue;
+    }
+
+    if (strcmp(argv[i], "--implied-vol") == 0) {
+      implied = true;
+
+      continue;
+    }
+
+    if (strcmp(argv[i], "--pages") == 0) {
+      assert (++i < argc);
+      if (!pages_parse(&pages, argv[i])) {
+        printf("\n");
+        printf("ERROR: Unknown page size \"%s\"\n", argv[i]);
+
+        parse_args_err = true;
+      }
+
+      continue;
+    }
+
+    if (strcmp(argv[i], "--placement") == 0) {
+      assert (++i < argc);
+      if (!place_parse(&placement, argv[i])) {
+        printf("\n");
+        printf("ERROR: Unknown placement \"%s\"\n", argv[i]);
+
+        parse_args_err = true;
+      }
+
+      continue;
+    }
+
     if (strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "--cpu") == 0) {
       assert (++i < argc);
       cpu = atoi(argv[i]);
@@ -168,27 +533,86 @@ int main(int argc, char** argv)
     }
   }
 
-  if (!parse_args_err && !help && impl == NULL) {
+  /* The modes are not combined; only --ab runs after any of them */
+  int nmodes = (noffs > 0) + (threads_max > 0) + implied + greeks;
+  if (!parse_args_err && !help && nmodes > 1) {
+    printf("\n");
+    printf("ERROR: --offset-sweep, --threads-sweep, --implied-vol and --greeks\n");
+    printf("       cannot be combined; choose one.\n");
+
+    parse_args_err = true;
+  }
+
+  if (!parse_args_err && !help && nsel > 0 && threads_max > 0) {
+    printf("\n");
+    printf("ERROR: --threads-sweep runs its own implementation; -i does not apply.\n");
+
+    parse_args_err = true;
+  }
+
+  if (!parse_args_err && !help && (greeks || implied || noffs > 0) && nsel == 0) {
+    printf("\n");
+    printf("ERROR: --%s needs the implementations to compare (-i).\n",
+           implied ? "implied-vol" : (greeks ? "greeks" : "offset-sweep"));
+
+    parse_args_err = true;
+  }
+
+  if (!parse_args_err && !help && nsel == 0 && nab == 0 && threads_max == 0) {
     printf("\n");
     printf("ERROR: No implementation was chosen.\n");
   }
 
-  if (help || impl == NULL || parse_args_err) {
+  if (help || (nsel == 0 && nab == 0 && threads_max == 0) || parse_args_err) {
     printf("\n");
     printf("Usage:\n");
-    printf("  %s {-i | --impl} impl_str [Options]\n", argv[0]);
+    printf("  %s {-i | --impl} impl_str[,impl_str...] [Options]\n", argv[0]);
     printf("  \n");
     printf("  Required:\n");
-    printf("    -i | --impl      Available implementations = {scalar, vec, para}\n");
+    printf("    -i | --impl      Available implementations = {");
+    impl_print_names(impls, nimpls);
+    printf("}\n");
+    printf("                     A comma-separated list or \"all\" runs several in one process.\n");
+    printf("                     (not required with --ab or --threads-sweep)\n");
     printf("    \n");
     printf("  Options:\n");
     printf("    -h | --help      Print this message\n");
     printf("    -n | --nthreads  Set number of threads available (default = %d)\n", nthreads);
+    printf("         --threads-sweep  Run the parallel implementation at each thread count in\n");
+    printf("                     min:max and report scaling and worker imbalance (e.g. 1:16)\n");
+    printf("         --spawn     Create the worker threads on every invocation instead of\n");
+    printf("                     dispatching to a persistent pool started once at startup\n");
     printf("    -c | --cpu       Set the main CPU for the program (default = %d)\n", cpu);
+    printf("         --placement  Placement of the worker threads on the CPUs (default = %s)\n", place_names[placement]);
+    printf("                     Available placements = {compact, scatter, nosmt, numa-spread}.\n");
+    printf("         --pages     Pages backing the data; falls back to smaller pages (default = %s)\n", pages_names[pages]);
+    printf("                     Available pages = {4k, thp, 2m, 1g}; see --counters dtlb-misses.\n");
+    printf("         --prefault  Populate and lock all memory, and fail if the runs page-fault\n");
     printf("    -d | --dataset   Dataset to be used (default = %s)\n", __dataset_name(dataset));
     printf("                     Available datasets = {test, dev, small, medium, large, native}.\n");
+    printf("         --align     Byte offsets of the arrays from a 4 KiB boundary; one for all\n");
+    printf("                     arrays, inputs,output, or one per array in the order\n");
+    printf("                     sptPrice,strike,rate,volatility,otime,otype,output\n");
+    printf("                     (multiples of %zu, default = 0)\n", sizeof(float));
+    printf("         --offset-sweep  Run at every combination of the comma-separated offsets for\n");
+    printf("                     the inputs (all at the same offset) and the output (e.g. 0,4,32)\n");
+    printf("         --greeks    Run each implementation pricing only, and computing the price\n");
+    printf("                     and the Greeks (delta, gamma, vega, theta, rho), and compare\n");
+    printf("         --implied-vol  Solve for the volatility of every option from its DerivaGem\n");
+    printf("                     price (Newton-Raphson, falling back to bisection) and report\n");
+    printf("                     solves/s, iterations and the lane-utilization loss\n");
     printf("         --nruns     Number of runs to the implementation (default = %d)\n", nruns);
     printf("         --stdevs    Number of standard deviation to exclude outliers (default = %d)\n", nstdevs);
+    printf("         --reps      Invocations per run; 0 calibrates it automatically (default = %d)\n", nreps);
+    printf("         --min-sample-us  Minimum duration of a run when calibrating --reps (default = %d)\n", min_sample_us);
+    printf("         --warmup-ms Maximum time spent warming up; 0 disables warmup (default = %d)\n", warmup_ms);
+    printf("         --ab        Interleave runs of a comma-separated list of implementations in a\n");
+    printf("                     randomized order and report paired differences (e.g. vec,para)\n");
+    printf("         --timer     Timer used to time each run (default = %s)\n", __timer_name(timer.src));
+    printf("                     Available timers = {clock, tsc}.\n");
+    printf("         --counters  Comma-separated performance counters to collect (default = none)\n");
+    printf("                     Available counters = {cycles, instructions, llc-misses,\n");
+    printf("                     branch-misses, dtlb-misses, page-faults, context-switches}.\n");
     printf("\n");
 
     exit(help? 0 : 1);
@@ -205,6 +629,22 @@ int main(int argc, char** argv)
     default: dataset_size = -1              ;
   }
 
+  /* Topology and thread placement; worker i runs on worker_cpus[i] */
+  topo_t topo;
+  topo_init(&topo);
+
+  int nworkers = (threads_max > nthreads) ? threads_max : nthreads;
+  if (nworkers > TOPO_MAX_CPUS) nworkers = TOPO_MAX_CPUS;
+
+  int worker_cpus[TOPO_MAX_CPUS];
+  if (topo_place(&topo, placement, cpu, nworkers, worker_cpus) < 0) {
+    printf("\n");
+    printf("ERROR: CPU %d is not used by the \"%s\" placement (--cpu)\n",
+                                               cpu, place_names[placement]);
+
+    exit(1);
+  }
+
   /* Set our priority the highest */
   int nice_level = -20;
 
@@ -246,8 +686,8 @@ int main(int argc, char** argv)
   cpu_set_t cpumask;
 
   CPU_ZERO(&cpumask);
-  for (int i = 0; i < nthreads; i++) {
-    CPU_SET(cpu + i, &cpumask);
+  for (int i = 0; i < nworkers; i++) {
+    CPU_SET(worker_cpus[i], &cpumask);
   }
 
   res = sched_setaffinity(pid, sizeof(cpumask), &cpumask);
@@ -258,24 +698,89 @@ int main(int argc, char** argv)
     printf("Succeeded\n");
   }
 #endif
+  topo_print(&topo);
+  topo_print_map(&topo, placement, worker_cpus, nworkers);
   printf("\n");
 
   /* Statistics */
   __DECLARE_STATS(nruns, nstdevs);
 
-  /* Initialize Rand */
-  srand(0xdeadbeef);
+  /* Timer */
+  printf("Calibrating the \"%s\" timer:\n", __timer_name(timer.src));
+  timer_calibrate(&timer);
+  if (timer.src == TIMER_TSC) {
+    printf("  * TSC frequency = %.3f MHz (%s)\n", 1e3 / timer.ns_per_tick,
+                             timer.invariant ? "invariant" : "NOT invariant");
+  }
+  printf("  * Timer source = %s\n", __timer_name(timer.src));
+  printf("  * Timer overhead = %.1f ns (subtracted from every run)\n",
+                                       timer.overhead * timer.ns_per_tick);
+  printf("\n");
+
+  /* Performance counters */
+  if (perf.nevents > 0) {
+    printf("Setting up performance counters:\n");
+    printf("  * Opening a group of %d counter(s):\n", perf.nevents);
+    perf_open(&perf);
+    printf("  * Counting %d counter(s)\n", perf.nevents);
+    printf("\n");
+  }
+
+  /* Worker pool */
+  pool_t pool;
+  if (!spawn) {
+    printf("Setting up the worker pool:\n");
+    printf("  * Starting %d pinned worker(s) ... ", nworkers);
+    if (pool_start(&pool, nworkers, worker_cpus)) {
+      printf("Succeeded\n");
+    } else {
+      printf("Failed, falling back to --spawn\n");
+      pool_stop(&pool);
+      spawn = true;
+    }
+    printf("\n");
+  } else {
+    printf("Spawning worker threads on every invocation (--spawn)\n");
+    printf("\n");
+  }
+
+  /* Pages backing the datasets */
+  arena_set_pages(pages);
+  arena_set_populate(prefault);
 
   /* Datasets */
-  /* Allocation and initialization */
-  float* sptPrice   = __ALLOC_DATA(float, dataset_size + 0);
-  float* strike     = __ALLOC_DATA(float, dataset_size + 0);
-  float* rate       = __ALLOC_DATA(float, dataset_size + 0);
-  float* volatility = __ALLOC_DATA(float, dataset_size + 0);
-  float* otime      = __ALLOC_DATA(float, dataset_size + 0);
-  char * otype      = __ALLOC_DATA(char , dataset_size + 0);
+  /* Allocation; room to start the arrays at any offset from a page */
+  size_t soa_len[SOA_NARRAYS];
+  byte*  soa_buf[SOA_NARRAYS];
+  for (int b = 0; b < SOA_NARRAYS; b++) {
+    size_t elem = (b == 5) ? sizeof(char) : sizeof(float);
+    soa_len[b]  = (size_t)dataset_size * elem;
+    soa_buf[b]  = __ALLOC_DATA(byte, soa_len[b] + sizeof(float) + ALIGN_PAD);
+  }
+
+  float* sptPrice   = (float*)(align_base(soa_buf[0]) + align[0]);
+  float* strike     = (float*)(align_base(soa_buf[1]) + align[1]);
+  float* rate       = (float*)(align_base(soa_buf[2]) + align[2]);
+  float* volatility = (float*)(align_base(soa_buf[3]) + align[3]);
+  float* otime      = (float*)(align_base(soa_buf[4]) + align[4]);
+  char * otype      = (char *)(align_base(soa_buf[5]) + align[5]);
   float* ref        = __ALLOC_DATA(float, dataset_size + 1);
-  float* dest       = __ALLOC_DATA(float, dataset_size + 1);
+  float* dest       = (float*)(align_base(soa_buf[6]) + align[6]);
+
+  /* Greeks, at the offset of the output, and their reference */
+  byte*  greek_buf[NGREEKS] = { NULL };
+  float* greek    [NGREEKS] = { NULL };
+  float* greek_ref[NGREEKS] = { NULL };
+  if (greeks) {
+    for (int g = 0; g < NGREEKS; g++) {
+      greek_buf[g] = __ALLOC_DATA(byte, soa_len[SOA_NARRAYS - 1] + sizeof(float) + ALIGN_PAD);
+      greek    [g] = (float*)(align_base(greek_buf[g]) + align[SOA_NARRAYS - 1]);
+      greek_ref[g] = __ALLOC_DATA(float, dataset_size + 1);
+    }
+  }
+
+  /* Market prices of --implied-vol */
+  float* market = implied ? __ALLOC_DATA(float, dataset_size + 1) : NULL;
 
   /* Initialize dest */
   for (int i = 0; i < dataset_size; i++) {
@@ -305,14 +810,98 @@ int main(int argc, char** argv)
   args_ref.output     = ref         ;
 
   args_ref.cpu        = cpu         ;
+  args_ref.cpus       = worker_cpus ;
   args_ref.nthreads   = nthreads    ;
 
-  /* Call genDataset to generate dataset and reference output */
+  args_ref.worker_ns  = NULL        ;
+  args_ref.pool       = spawn ? NULL : &pool;
+
+  greeks_set(&args_ref, NULL);
+
+  args_ref.market     = NULL        ;
+  args_ref.iv_stats   = NULL        ;
+
+  /* Call genDataset to generate dataset and the DerivaGem prices */
   printf("  * Invoking genDataset .... ");
-  genDataset(&args_ref);
+  genDataset(&args_ref, spawn ? NULL : &pool, worker_cpus, nworkers);
+  printf("Finished\n");
+
+  /* Reference prices in double precision, one slice per worker, into *
+   * dest first, to compare them with the DerivaGem prices in ref.     */
+  printf("  * Computing the double-precision reference .... ");
+  {
+    args_t slices[nworkers];
+    void*  targs [nworkers];
+    size_t per = dataset_size / nworkers;
+    for (int w = 0; w < nworkers; w++) {
+      size_t off = (size_t)w * per;
+      size_t sz  = (w == nworkers - 1) ? (dataset_size - off) : per;
+
+      slices[w]            = args_ref;
+      slices[w].num_stocks = sz;
+      slices[w].sptPrice   = sptPrice   + off;
+      slices[w].strike     = strike     + off;
+      slices[w].rate       = rate       + off;
+      slices[w].volatility = volatility + off;
+      slices[w].otime      = otime      + off;
+      slices[w].otype      = otype      + off;
+      slices[w].output     = dest       + off;
+      targs[w]             = &slices[w];
+
+      if (greeks) {
+        float* g_off[NGREEKS];
+        for (int g = 0; g < NGREEKS; g++) g_off[g] = greek_ref[g] + off;
+        greeks_set(&slices[w], g_off);
+      }
+    }
+
+    pool_run_once(spawn ? NULL : &pool, worker_cpus, impl_ref, targs, nworkers);
+  }
   printf("Finished\n");
+
+  double dg_diff = 0.0;
+  for (int i = 0; i < dataset_size; i++) {
+    double d = fabs((double)dest[i] - (double)ref[i]);
+    if (d > dg_diff) dg_diff = d;
+  }
+  printf("    + Largest difference to DerivaGem: %.3g\n", dg_diff);
+
+  /* The DerivaGem prices are the market prices of --implied-vol */
+  if (implied) {
+    memcpy(market, ref, dataset_size * sizeof(float));
+  }
+
+  memcpy(ref, dest, dataset_size * sizeof(float));
+  for (int i = 0; i < dataset_size; i++) {
+    dest[i] = 0.0f;
+  }
+  printf("\n");
+
+  /* Pages actually obtained, now that they were touched */
+  printf("Page backing (pages = %s):\n", pages_names[pages]);
+  arena_report("sptPrice", soa_buf[0]);
+  arena_report("output"  , soa_buf[SOA_NARRAYS - 1]);
+  printf("\n");
+
+  printf("Array offsets from a 4 KiB boundary (--align):\n");
+  for (int b = 0; b < SOA_NARRAYS; b++) {
+    printf("  * %-10s = %zu\n", soa_names[b], align[b]);
+  }
   printf("\n");
 
+  /* Everything is touched by now; keep it resident */
+  if (prefault) {
+    printf("Locking memory (--prefault) .... ");
+    if (!faults_lock()) {
+      printf("Failed\n");
+      printf("\n");
+      printf("ERROR: Cannot lock the memory of --prefault (see ulimit -l)\n");
+      exit(-3);
+    }
+    printf("Succeeded\n");
+    printf("\n");
+  }
+
   /* Execute the requested implementation */
   /* Arguments for the function */
   args_t args;
@@ -328,165 +917,335 @@ int main(int argc, char** argv)
   args.output     = dest        ;
 
   args.cpu        = cpu         ;
+  args.cpus       = worker_cpus ;
   args.nthreads   = nthreads    ;
 
-  /* Start execution */
-  printf("Running \"%s\" implementation:\n", impl_str);
-
-  printf("  * Invoking the implementation %d times .... ", num_runs);
-  for (int i = 0; i < num_runs; i++) {
-    __SET_START_TIME();
-    for (int j = 0; j < 4; j++) {
-      (*impl)(&args);
+  args.worker_ns  = NULL        ;
+  args.pool       = spawn ? NULL : &pool;
+
+  greeks_set(&args, NULL);
+
+  args.market     = NULL        ;
+  args.iv_stats   = NULL        ;
+
+  /* Measurement loops on the output of args */
+  output_t out;
+
+  out.args      = &args;
+  out.ref       = ref;
+  out.greek     = greek;
+  out.greek_ref = greek_ref;
+
+  bench_t bench;
+
+  bench.timer         = &timer;
+  bench.perf          = &perf;
+  bench.runtimes      = runtimes;
+  bench.runtimes_mask = runtimes_mask;
+  bench.counters      = counters;
+  bench.num_runs      = num_runs;
+  bench.nstd          = nstd;
+  bench.nelems        = dataset_size;
+  bench.nreps         = nreps;
+  bench.min_sample_us = min_sample_us;
+  bench.warmup_ms     = warmup_ms;
+  bench.prefault      = prefault;
+  bench.faults_failed = false;
+  bench.verbose       = false;
+  bench.reset         = output_reset;
+  bench.check         = output_check;
+  bench.ctx           = &out;
+
+  /* Options per second */
+  bench_rate_t throughput = { (double)dataset_size, 1e3, "Mopt/s", "options_per_sec" };
+
+  /* Offset sweep: the inputs and the output at every combination */
+  if (noffs > 0) {
+    groups_t groups;
+
+    groups.args = &args;
+    groups.bufs = soa_buf;
+    groups.lens = soa_len;
+    memcpy(groups.cur, align, sizeof(groups.cur));
+
+    bench_offset_sweep(&bench, impls, sel, nsel, &args, offs, noffs, 2,
+                       group_names, groups_place, &groups, &throughput);
+
+    /* Restore the offsets of --align for the remaining modes */
+    soa_place(&args, soa_buf, soa_len, groups.cur, align);
+    dest = args.output;
+    output_reset(&out);
+  } else /* Thread-scaling sweep of the parallel implementation */
+  if (threads_max > 0) {
+    bench_threads_sweep(&bench, impl_parallel, &args, threads_set,
+                        threads_min, threads_max, &throughput);
+
+    /* Restore the requested thread count for the remaining modes */
+    args.nthreads = nthreads;
+  } else /* Implied volatility from the DerivaGem prices */
+  if (implied) {
+    printf("Running implied-volatility solver on the DerivaGem prices:\n");
+
+    printf("  * Dumping results to implied_vol.csv .... ");
+    FILE* fp = fopen("implied_vol.csv", "w");
+    printf("%s\n", (fp != NULL) ? "Succeeded" : "Failed");
+
+    if (fp != NULL) {
+      fprintf(fp, "impl,invocations_per_run,median_ns,median_ci95_lo,"
+                  "median_ci95_hi,solves_per_sec,avg_iterations,"
+                  "lane_utilization_loss,failed,check");
+      perf_csv_header(fp, &perf);
+      fprintf(fp, "\n");
     }
-    __SET_END_TIME();
-    runtimes[i] = __CALC_RUNTIME() / 4;
-  }
-  printf("Finished\n");
 
-  /* Verfication */
-  printf("  * Verifying results .... ");
+    printf("  %-16s %14s %12s %10s %10s %8s %10s", "impl", "median (ns)",
+           "Msolves/s", "avg iters", "util loss", "failed", "check");
+    perf_header(&perf, "");
+    printf("\n");
 
-  bool match = __CHECK_FLOAT_MATCH(ref, dest, dataset_size, 1e-4);
-  bool guard = __CHECK_GUARD(dest, dataset_size * sizeof(float));
+    iv_stats_t* iv_stats = (iv_stats_t*)calloc(nworkers, sizeof(iv_stats_t));
 
-  if (match && guard) {
-    printf("Success\n");
-  } else if (!match && guard) {
-    printf("Fail, but no buffer overruns\n");
-  } else if (match && !guard) {
-    printf("Success, but failed buffer overruns check\n");
-  } else if(!match && !guard) {
-    printf("Failed, and failed buffer overruns check\n");
-  }
+    args.market = market;
 
-  /* Running analytics */
-  uint64_t min     = -1;
-  uint64_t max     =  0;
+    for (int k = 0; k < nsel; k++) {
+      void* (*impl)(void* args) = impls[sel[k]].fn;
+      const char* impl_str      = impls[sel[k]].str;
 
-  uint64_t avg     =  0;
-  uint64_t avg_n   =  0;
+      bench_point_t pt = bench_measure(&bench, impl, &args);
 
-  uint64_t std     =  0;
-  uint64_t std_n   =  0;
+      /* One more invocation, counting the solver iterations */
+      memset(iv_stats, 0, nworkers * sizeof(iv_stats_t));
+      args.iv_stats = iv_stats;
+      (*impl)(&args);
+      args.iv_stats = NULL;
+
+      iv_stats_t total = { 0 };
+      for (int w = 0; w < nworkers; w++) {
+        total.solves += iv_stats[w].solves;
+        total.iters  += iv_stats[w].iters ;
+        total.slots  += iv_stats[w].slots ;
+        total.failed += iv_stats[w].failed;
+      }
 
-  int      n_msked =  0;
-  int      n_stats =  0;
+      double thr   = bench_rate(&throughput, pt.stats.median);
+      double iters = (total.solves > 0) ? ((double)total.iters / total.solves) : 0.0;
+      double loss  = (total.slots  > 0) ? (1.0 - (double)total.iters / total.slots) : 0.0;
+
+      printf("  %-16s %14.1f %12.3f %10.2f %9.1f%% %8" PRIu64 " %10s", impl_str,
+             pt.stats.median, thr, iters, loss * 100.0, total.failed,
+             __PRINT_MATCH(pt.match));
+      perf_row(&perf, &pt.counters, "");
+      printf("\n");
+
+      if (fp != NULL) {
+        fprintf(fp, "%s,%d,%f,%f,%f,%f,%f,%f,%" PRIu64 ",%s", impl_str, pt.reps,
+                    pt.stats.median, pt.stats.ci_lo, pt.stats.ci_hi,
+                    bench_rate_per_sec(&throughput, pt.stats.median), iters,
+                    loss, total.failed, __PRINT_MATCH(pt.match));
+        perf_csv_row(fp, &perf, &pt.counters);
+        fprintf(fp, "\n");
+      }
+    }
 
-  for (int i = 0; i < num_runs; i++)
-    runtimes_mask[i] = true;
+    if (fp != NULL) {
+      fclose(fp);
+    }
+    printf("\n");
 
-  printf("  * Running statistics:\n");
-  do {
-    n_stats++;
-    printf("    + Starting statistics run number #%d:\n", n_stats);
-    avg_n =  0;
-    avg   =  0;
-
-    /*   -> Calculate min, max, and avg */
-    for (int i = 0; i < num_runs; i++) {
-      if (runtimes_mask[i]) {
-        if (runtimes[i] < min) {
-          min = runtimes[i];
-        }
-        if (runtimes[i] > max) {
-          max = runtimes[i];
-        }
-        avg += runtimes[i];
-        avg_n += 1;
-      }
+    free(iv_stats);
+
+    /* Price for the remaining modes */
+    args.market = NULL;
+  } else /* Price only against price and Greeks */
+  if (greeks) {
+    printf("Running price-only against price-and-Greeks:\n");
+
+    printf("  * Dumping comparison to greeks.csv .... ");
+    FILE* fp = fopen("greeks.csv", "w");
+    printf("%s\n", (fp != NULL) ? "Succeeded" : "Failed");
+
+    if (fp != NULL) {
+      fprintf(fp, "impl,mode,invocations_per_run,median_ns,median_ci95_lo,"
+                  "median_ci95_hi,options_per_sec,check");
+      perf_csv_header(fp, &perf);
+      fprintf(fp, "\n");
     }
-    avg = avg / avg_n;
 
-    /*   -> Calculate standard deviation */
-    std   =  0;
-    std_n =  0;
+    /* The counters of both modes follow on each row */
+    printf("  %-16s %14s %12s %14s %12s %9s %10s", "impl", "price (ns)",
+           "Mopt/s", "+greeks (ns)", "Mopt/s", "cost", "check");
+    perf_header(&perf, "");
+    perf_header(&perf, "+greeks ");
+    printf("\n");
 
-    for (int i = 0; i < num_runs; i++) {
-      if (runtimes_mask[i]) {
-        std   += ((runtimes[i] - avg) *
-                  (runtimes[i] - avg));
-        std_n += 1;
+    for (int k = 0; k < nsel; k++) {
+      void* (*impl)(void* args) = impls[sel[k]].fn;
+      const char* impl_str      = impls[sel[k]].str;
+
+      double       median[2];
+      double       thr   [2];
+      perf_point_t cnt   [2];
+      bool         ok = true;
+
+      /* m = 0 prices only, m = 1 computes the Greeks too */
+      for (int m = 0; m < 2; m++) {
+        greeks_set(&args, (m == 1) ? greek : NULL);
+
+        bench_point_t pt = bench_measure(&bench, impl, &args);
+        ok = ok && pt.match;
+
+        median[m] = pt.stats.median;
+        thr   [m] = bench_rate(&throughput, pt.stats.median);
+        cnt   [m] = pt.counters;
+
+        if (fp != NULL) {
+          fprintf(fp, "%s,%s,%d,%f,%f,%f,%f,%s", impl_str,
+                      (m == 1) ? "greeks" : "price", pt.reps, pt.stats.median,
+                      pt.stats.ci_lo, pt.stats.ci_hi,
+                      bench_rate_per_sec(&throughput, pt.stats.median),
+                      __PRINT_MATCH(pt.match));
+          perf_csv_row(fp, &perf, &pt.counters);
+          fprintf(fp, "\n");
+        }
       }
+
+      printf("  %-16s %14.1f %12.3f %14.1f %12.3f %8.2fx %10s", impl_str,
+             median[0], thr[0], median[1], thr[1],
+             (median[0] > 0.0) ? (median[1] / median[0]) : 0.0,
+             __PRINT_MATCH(ok));
+      perf_row(&perf, &cnt[0], "");
+      perf_row(&perf, &cnt[1], "+greeks ");
+      printf("\n");
     }
-    std = sqrt(std / std_n);
-
-    /*   -> Calculate outlier-free average (mean) */
-    n_msked = 0;
-    for (int i = 0; i < num_runs; i++) {
-      if (runtimes_mask[i]) {
-        if (runtimes[i] > avg) {
-          if ((runtimes[i] - avg) > (nstd * std)) {
-            runtimes_mask[i] = false;
-            n_msked += 1;
-          }
-        } else {
-          if ((avg - runtimes[i]) > (nstd * std)) {
-            runtimes_mask[i] = false;
-            n_msked += 1;
-          }
+
+    if (fp != NULL) {
+      fclose(fp);
+    }
+    printf("\n");
+
+    /* Price only for the remaining modes */
+    greeks_set(&args, NULL);
+  } else {
+    /* Run all selected implementations on the same buffers */
+    double medians[IMPL_MAX];
+    bool   matches[IMPL_MAX];
+
+    /* Follow every step of the measurement */
+    bench.verbose = true;
+
+    for (int k = 0; k < nsel; k++) {
+      void* (*impl)(void* args) = impls[sel[k]].fn;
+      const char* impl_str      = impls[sel[k]].str;
+
+      /* Start execution */
+      printf("Running \"%s\" implementation:\n", impl_str);
+      bench_point_t pt = bench_measure(&bench, impl, &args);
+
+      /* Running analytics */
+      stats_t stats = pt.stats;
+
+      printf("  * Running statistics:\n");
+      stats_print(&stats);
+
+      /* Display information */
+      printf("  * Runtimes (%s): ", __PRINT_MATCH(pt.match));
+      printf(" %.1f ns\n"        , stats.median        );
+
+      /* Performance counters */
+      perf_summary(&perf, counters, runtimes_mask, num_runs, dataset_size);
+
+      /* Dump */
+      printf("  * Dumping runtime informations:\n");
+      FILE * fp;
+      char filename[256];
+      strcpy(filename, impl_str);
+      strcat(filename, "_runtimes.csv");
+      printf("    - Filename: %s\n", filename);
+      printf("    - Opening file .... ");
+      fp = fopen(filename, "w");
+
+      if (fp != NULL) {
+        printf("Succeeded\n");
+        printf("    - Writing runtimes ... ");
+        fprintf(fp, "impl,%s", impl_str);
+
+        fprintf(fp, "\n");
+        fprintf(fp, "timer,%s", __timer_name(timer.src));
+
+        fprintf(fp, "\n");
+        fprintf(fp, "timer_overhead_ns,%f", timer.overhead * timer.ns_per_tick);
+
+        fprintf(fp, "\n");
+        fprintf(fp, "num_of_runs,%d", num_runs);
+
+        fprintf(fp, "\n");
+        fprintf(fp, "invocations_per_run,%d", pt.reps);
+
+        fprintf(fp, "\n");
+        fprintf(fp, "minor_faults,%" PRIu64 "", pt.faults.minor);
+
+        fprintf(fp, "\n");
+        fprintf(fp, "major_faults,%" PRIu64 "", pt.faults.major);
+
+        fprintf(fp, "\n");
+        fprintf(fp, "runtimes");
+        for (int i = 0; i < num_runs; i++) {
+          fprintf(fp, ", ");
+          fprintf(fp, "%.3f", runtimes[i]);
         }
+
+        stats_dump(fp, &stats);
+        perf_dump(fp, &perf, counters, runtimes_mask, num_runs, dataset_size);
+        printf("Finished\n");
+        printf("    - Closing file handle .... ");
+        fclose(fp);
+        printf("Finished\n");
+      } else {
+        printf("Failed\n");
       }
-    }
+      printf("\n");
 
-    printf("      - Standard deviation = %" PRIu64 "\n", std);
-    printf("      - Average = %" PRIu64 "\n", avg);
-    printf("      - Number of active elements = %" PRIu64 "\n", avg_n);
-    printf("      - Number of masked-off = %d\n", n_msked);
-  } while (n_msked > 0);
-  /* Display information */
-  printf("  * Runtimes (%s): ", __PRINT_MATCH(match));
-  printf(" %" PRIu64 " ns\n"  , avg                 );
-
-  /* Dump */
-  printf("  * Dumping runtime informations:\n");
-  FILE * fp;
-  char filename[256];
-  strcpy(filename, impl_str);
-  strcat(filename, "_runtimes.csv");
-  printf("    - Filename: %s\n", filename);
-  printf("    - Opening file .... ");
-  fp = fopen(filename, "w");
-
-  if (fp != NULL) {
-    printf("Succeeded\n");
-    printf("    - Writing runtimes ... ");
-    fprintf(fp, "impl,%s", impl_str);
+      medians[k] = stats.median;
+      matches[k] = pt.match;
+    }
 
-    fprintf(fp, "\n");
-    fprintf(fp, "num_of_runs,%d", num_runs);
+    bench.verbose = false;
 
-    fprintf(fp, "\n");
-    fprintf(fp, "runtimes");
-    for (int i = 0; i < num_runs; i++) {
-      fprintf(fp, ", ");
-      fprintf(fp, "%" PRIu64 "", runtimes[i]);
+    /* Comparison table */
+    if (nsel > 1) {
+      impl_summary(impls, sel, nsel, medians, matches,
+                   (double)dataset_size, 1e3, "Mopt/s");
     }
+  }
 
-    fprintf(fp, "\n");
-    fprintf(fp, "avg,%" PRIu64 "", avg);
-    printf("Finished\n");
-    printf("    - Closing file handle .... ");
-    fclose(fp);
-    printf("Finished\n");
-  } else {
-    printf("Failed\n");
+  /* Interleaved A/B comparison */
+  if (nab > 0) {
+    bench_ab(&bench, impls, ab_sel, nab, &args);
   }
-  printf("\n");
 
   /* Manage memory */
-  free(sptPrice);
-  free(strike);
-  free(rate);
-  free(volatility);
-  free(otime);
-  free(otype);
-  free(dest);
-  free(ref);
+  for (int b = 0; b < SOA_NARRAYS; b++) {
+    __FREE_DATA(soa_buf[b]);
+  }
+  __FREE_DATA(ref);
+  if (market != NULL) {
+    __FREE_DATA(market);
+  }
+  for (int g = 0; g < NGREEKS; g++) {
+    if (greek_buf[g] != NULL) {
+      __FREE_DATA(greek_buf[g]);
+      __FREE_DATA(greek_ref[g]);
+    }
+  }
+
+  /* Stop the worker pool */
+  if (!spawn) {
+    pool_stop(&pool);
+  }
 
   /* Finished with statistics */
   __DESTROY_STATS();
 
-  /* Done */
-  return 0;
+  /* Done; page faults under --prefault fail the run */
+  return bench.faults_failed ? -3 : 0;
 }
@@ -0,0 +1,73 @@
+/* align.h
+ *
+ * Author: Khalid Al-Hawaj
+ * Date  : 16 Oct. 2026
+ *
+ * This file contains the placement of the buffers at chosen byte offsets
+ * (--align and --offset-sweep). Production code rarely sees arrays that
+ * start on a cache line; they sit at arbitrary offsets inside larger
+ * records. Each buffer is therefore allocated with ALIGN_PAD extra bytes,
+ * its base is rounded up to a 4 KiB boundary, and the data starts at an
+ * offset from that base. Offsets that are not a multiple of the vector
+ * width split vector accesses across cache lines, and buffers at the same
+ * offset are 4K-aliased: their addresses only differ above bit 11.
+ *
+ * Offsets are in bytes, below a page and a multiple of the element size,
+ * so that every element stays naturally aligned.
+*/
+
+#ifndef __COMMON_ALIGN_H_
+#define __COMMON_ALIGN_H_
+
+/* Standard C includes */
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+/* Include common headers */
+#include "common/types.h"
+
+/* Limits */
+#define ALIGN_PAGE     4096
+#define ALIGN_PAD      (2 * ALIGN_PAGE)  /* rounding the base, and the offset */
+#define ALIGN_MAX_OFFS 64
+
+/* Parse a comma-separated list of at most max offsets; returns false  *
+ * if one is malformed, not below a page or not a multiple of elem.    */
+static inline bool align_parse(const char* str, size_t elem, size_t* offs,
+                               int max, int* n)
+{
+  *n = 0;
+
+  while (*str != '\0') {
+    char* end;
+    unsigned long long off = strtoull(str, &end, 0);
+
+    if (end == str || (*end != ',' && *end != '\0')) return false;
+    if (off >= ALIGN_PAGE || (off % elem) != 0)       return false;
+    if (*n >= max)                                     return false;
+
+    offs[(*n)++] = (size_t)off;
+
+    str = (*end == ',') ? (end + 1) : end;
+  }
+
+  return *n > 0;
+}
+
+/* The first 4 KiB boundary of an allocation padded with ALIGN_PAD */
+static inline byte* align_base(void* raw)
+{
+  return (byte*)(((uintptr_t)raw + ALIGN_PAGE - 1) & ~(uintptr_t)(ALIGN_PAGE - 1));
+}
+
+/* Move the len bytes of a buffer from one offset to another */
+static inline byte* align_move(byte* base, size_t from, size_t to, size_t len)
+{
+  if (from != to) memmove(base + to, base + from, len);
+
+  return base + to;
+}
+
+#endif //__COMMON_ALIGN_H_
@@ -0,0 +1,282 @@
+/* arena.h
+ *
+ * Author: Khalid Al-Hawaj
+ * Date  : 16 Oct. 2026
+ *
+ * This file contains the mmap-backed arena used by __ALLOC_DATA for large
+ * buffers (ARENA_THRESHOLD and above). Each such buffer is its own
+ * anonymous, private mapping, so multi-GiB working sets do not go
+ * through the heap, start page-aligned, and are returned to the kernel
+ * as soon as they are freed. The arena remembers its mappings, so that
+ * __FREE_DATA can tell them apart from heap buffers.
+ *
+ * The page size of the mappings can be chosen with arena_set_pages():
+ *
+ *   4k : regular pages
+ *   thp: a 2 MiB-aligned mapping with madvise(MADV_HUGEPAGE)
+ *   2m : MAP_HUGETLB with 2 MiB pages, from the hugetlb pool
+ *   1g : MAP_HUGETLB with 1 GiB pages, from the hugetlb pool
+ *
+ * With anything but 4k, every buffer goes through the arena. If the
+ * hugetlb pool cannot back a mapping, the arena falls back to THP and
+ * then to regular pages. What the kernel actually did is read back from
+ * /proc/self/smaps (KernelPageSize and AnonHugePages) once the pages
+ * have been touched.
+ *
+ * With arena_set_populate() (--prefault), every buffer goes through the
+ * arena as well, and its pages are faulted in when it is mapped: with
+ * MAP_POPULATE, or by touching every page after madvise() for THP.
+*/
+
+#ifndef __COMMON_ARENA_H_
+#define __COMMON_ARENA_H_
+
+/* Standard C includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#if defined(__linux__)
+#include <linux/mman.h>
+#endif
+
+/* Include common headers */
+#include "common/types.h"
+
+/* Limits */
+#define ARENA_MAX_REGIONS 64
+#define ARENA_THRESHOLD   (64llu << 20)
+#define ARENA_THP_SIZE    (2llu  << 20)
+
+/* Page sizes */
+typedef enum {
+  PAGES_4K = 0,
+  PAGES_THP,
+  PAGES_2M,
+  PAGES_1G
+} pages_t;
+
+static const char* const pages_names[] = {
+  "4k", "thp", "2m", "1g"
+};
+
+typedef struct {
+  void*   addr;
+  size_t  len;
+  pages_t requested;
+  pages_t mapped;     /* after falling back */
+} arena_region_t;
+
+typedef struct {
+  pages_t        pages;
+  bool           populate;
+  int            nregions;
+  arena_region_t regions[ARENA_MAX_REGIONS];
+} arena_t;
+
+/* The arena of this translation unit */
+static inline arena_t* __arena(void)
+{
+  static arena_t arena;
+  return &arena;
+}
+
+static inline bool pages_parse(pages_t* p, const char* str)
+{
+  for (int k = 0; k < (int)(sizeof(pages_names) / sizeof(pages_names[0])); k++) {
+    if (strcasecmp(str, pages_names[k]) == 0) { *p = (pages_t)k; return true; }
+  }
+
+  return false;
+}
+
+static inline void arena_set_pages(pages_t pages)
+{
+  __arena()->pages = pages;
+}
+
+static inline void arena_set_populate(bool populate)
+{
+  __arena()->populate = populate;
+}
+
+/* Whether an allocation of nbytes should come from the arena */
+static inline bool arena_wants(size_t nbytes)
+{
+  arena_t* a = __arena();
+
+  return (nbytes >= ARENA_THRESHOLD) || (a->pages != PAGES_4K) || a->populate;
+}
+
+/* Map len bytes with the given pages; NULL on failure */
+static inline void* __arena_map(size_t len, pages_t pages, bool populate)
+{
+  int   flags = MAP_PRIVATE | MAP_ANONYMOUS;
+  void* addr;
+
+#if defined(MAP_POPULATE)
+  if (populate && pages != PAGES_THP) flags |= MAP_POPULATE;
+#endif
+
+  switch (pages) {
+#if defined(MAP_HUGETLB) && defined(MAP_HUGE_SHIFT)
+    case PAGES_2M:
+    case PAGES_1G:
+      flags |= MAP_HUGETLB | (((pages == PAGES_1G) ? 30 : 21) << MAP_HUGE_SHIFT);
+      addr   = mmap(NULL, len, PROT_READ | PROT_WRITE, flags, -1, 0);
+      return (addr == MAP_FAILED) ? NULL : addr;
+#endif
+
+#if defined(MADV_HUGEPAGE)
+    case PAGES_THP: {
+      /* Over-map, then trim to a 2 MiB-aligned window */
+      size_t    span = len + ARENA_THP_SIZE;
+      byte*     raw  = (byte*)mmap(NULL, span, PROT_READ | PROT_WRITE, flags, -1, 0);
+      if (raw == (byte*)MAP_FAILED) return NULL;
+
+      uintptr_t lo   = ((uintptr_t)raw + ARENA_THP_SIZE - 1) & ~(uintptr_t)(ARENA_THP_SIZE - 1);
+      size_t    head = lo - (uintptr_t)raw;
+      size_t    tail = span - head - len;
+      if (head > 0) munmap(raw, head);
+      if (tail > 0) munmap((byte*)lo + len, tail);
+
+      madvise((void*)lo, len, MADV_HUGEPAGE);
+
+      /* Populate after madvise, so the faults can use huge pages */
+      if (populate) {
+        size_t psz = (size_t)sysconf(_SC_PAGESIZE);
+        for (size_t off = 0; off < len; off += psz) {
+          ((volatile byte*)lo)[off] = 0;
+        }
+      }
+      return (void*)lo;
+    }
+#endif
+
+    default:
+      addr = mmap(NULL, len, PROT_READ | PROT_WRITE, flags, -1, 0);
+      return (addr == MAP_FAILED) ? NULL : addr;
+  }
+}
+
+/* Map nbytes with the arena's pages (rounded up to them), falling back *
+ * to smaller pages; NULL on failure                                    */
+static inline void* arena_alloc(size_t nbytes)
+{
+  arena_t* a = __arena();
+
+  if (a->nregions >= ARENA_MAX_REGIONS) return NULL;
+
+  for (int pages = a->pages; pages >= PAGES_4K; pages--) {
+    /* 1g falls back to 2m, and both to THP; THP to regular pages */
+    size_t psz = (pages == PAGES_1G) ? (1llu << 30) :
+                 (pages == PAGES_2M) ? (2llu << 20) :
+                 (size_t)sysconf(_SC_PAGESIZE);
+    size_t len = (nbytes + psz - 1) & ~(psz - 1);
+    if (len < nbytes) return NULL;
+
+    void* addr = __arena_map(len, (pages_t)pages, a->populate);
+    if (addr == NULL) continue;
+
+    a->regions[a->nregions++] = (arena_region_t){
+      .addr = addr, .len = len, .requested = a->pages, .mapped = (pages_t)pages
+    };
+
+    return addr;
+  }
+
+  return NULL;
+}
+
+/* The mapping holding ptr, or NULL if it did not come from the arena */
+static inline arena_region_t* arena_find(const void* ptr)
+{
+  arena_t* a = __arena();
+
+  for (int i = 0; i < a->nregions; i++) {
+    if (a->regions[i].addr == ptr) return &a->regions[i];
+  }
+
+  return NULL;
+}
+
+/* Unmap ptr; returns false if it did not come from the arena */
+static inline bool arena_free(void* ptr)
+{
+  arena_t*        a = __arena();
+  arena_region_t* r = arena_find(ptr);
+
+  if (r == NULL) return false;
+
+  munmap(r->addr, r->len);
+  *r = a->regions[--a->nregions];
+
+  return true;
+}
+
+/* Backing of the mapping holding ptr, from /proc/self/smaps (in KiB); *
+ * returns false if it cannot be read.                                  */
+static inline bool arena_backing(const void* ptr, size_t* page_kb,
+                                 size_t* rss_kb, size_t* thp_kb)
+{
+  FILE* fp = fopen("/proc/self/smaps", "r");
+  if (fp == NULL) return false;
+
+  char line[512];
+  bool in    = false;
+  bool found = false;
+
+  *page_kb = 0; *rss_kb = 0; *thp_kb = 0;
+  while (fgets(line, sizeof(line), fp) != NULL) {
+    unsigned long lo, hi;
+    if (sscanf(line, "%lx-%lx ", &lo, &hi) == 2) {
+      if (found) break;
+      in    = ((uintptr_t)ptr >= lo) && ((uintptr_t)ptr < hi);
+      found = in;
+      continue;
+    }
+    if (!in) continue;
+
+    size_t kb;
+    if (sscanf(line, "KernelPageSize: %zu kB", &kb) == 1) *page_kb = kb;
+    if (sscanf(line, "Rss: %zu kB"           , &kb) == 1) *rss_kb  = kb;
+    if (sscanf(line, "AnonHugePages: %zu kB" , &kb) == 1) *thp_kb  = kb;
+  }
+  fclose(fp);
+
+  return found;
+}
+
+/* Print the pages that actually back a buffer (after it was touched) */
+static inline void arena_report(const char* name, const void* ptr)
+{
+  arena_region_t* r = arena_find(ptr);
+  size_t page_kb, rss_kb, thp_kb;
+
+  printf("    + %-8s: ", name);
+  if (!arena_backing(ptr, &page_kb, &rss_kb, &thp_kb)) {
+    printf("backing is not available\n");
+    return;
+  }
+
+  if (r != NULL && r->mapped != r->requested) {
+    printf("requested %s, fell back to %s; ", pages_names[r->requested],
+                                              pages_names[r->mapped]);
+  }
+
+  if (page_kb >= 1024) {
+    printf("%zu MiB hugetlb pages\n", page_kb >> 10);
+  } else if (thp_kb > 0) {
+    printf("%zu KiB pages, %.1f%% in 2 MiB THP\n", page_kb,
+                           (rss_kb > 0) ? (100.0 * thp_kb / rss_kb) : 0.0);
+  } else {
+    printf("%zu KiB pages\n", page_kb);
+  }
+}
+
+#endif //__COMMON_ARENA_H_
@@ -0,0 +1,549 @@
+/* bench.h
+ *
+ * Author: Khalid Al-Hawaj
+ * Date  : 16 Oct. 2026
+ *
+ * This file contains the measurement loops shared by the harnesses. A
+ * bench_t carries the timer, the counters and the sample buffers of
+ * __DECLARE_STATS, the measurement options, and two callbacks on the
+ * output of the benchmark: reset() clears it and sets its guard, and
+ * check() compares it with the reference (guard included). The loops
+ * only see the implementations and their opaque arguments; everything
+ * specific to a benchmark stays behind the callbacks.
+ *
+ * bench_measure() measures one point of a sweep, or one implementation
+ * of the default mode, which sets 'verbose' to follow every step of the
+ * measurement; the thread-scaling and offset sweeps, and the A/B
+ * comparison, are complete modes. Throughput
+ * is reported through a bench_rate_t, the work of one invocation and
+ * its unit. Every timed run also fills the counters of --counters, which
+ * the tables of the modes show per element of an invocation.
+*/
+
+#ifndef __COMMON_BENCH_H_
+#define __COMMON_BENCH_H_
+
+/* Standard C includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+/* Include common headers */
+#include "common/types.h"
+#include "common/macros.h"
+#include "common/perf.h"
+#include "common/timer.h"
+#include "common/stats.h"
+#include "common/impl.h"
+#include "common/faults.h"
+
+typedef struct {
+  /* Timer and counters of the harness */
+  timer_cfg_t*  timer;
+  perf_group_t* perf;
+
+  /* Sample buffers of __DECLARE_STATS */
+  double*       runtimes;
+  bool*         runtimes_mask;
+  uint64_t*     counters;
+  uint32_t      num_runs;
+  unsigned int  nstd;
+
+  /* Elements of one invocation, for the per-element counters */
+  size_t        nelems;
+
+  /* Invocations per run (0 to calibrate), minimum sample time and *
+   * warmup budget                                                  */
+  int           nreps;
+  int           min_sample_us;
+  int           warmup_ms;
+
+  /* Page faults fail the run (--prefault); set when a loop faulted */
+  bool          prefault;
+  bool          faults_failed;
+
+  /* Print every step of bench_measure(), and the faults of every loop */
+  bool          verbose;
+
+  /* Output of the benchmark */
+  void        (*reset)(void* ctx);
+  bool        (*check)(void* ctx);
+  void*         ctx;
+} bench_t;
+
+/* Throughput of one invocation: 'work' units, and 'scale' converts *
+ * work/ns into 'unit'                                                */
+typedef struct {
+  double      work;
+  double      scale;
+  const char* unit;     /* of the printed rate, e.g. "GB/s"         */
+  const char* column;   /* CSV column of the rate per second         */
+} bench_rate_t;
+
+/* One measured point */
+typedef struct {
+  int          reps;    /* invocations per run            */
+  stats_t      stats;   /* of the per-invocation runtimes */
+  perf_point_t counters;/* of the runs kept by the stats  */
+  faults_t     faults;  /* of the timed runs              */
+  bool         match;   /* output and guard check         */
+} bench_point_t;
+
+static inline double bench_rate(const bench_rate_t* r, double ns)
+{
+  return (ns > 0.0) ? (r->work / ns * r->scale) : 0.0;
+}
+
+static inline double bench_rate_per_sec(const bench_rate_t* r, double ns)
+{
+  return (ns > 0.0) ? (r->work / ns * 1e9) : 0.0;
+}
+
+/* Reset the output, warm 'impl' up and calibrate the invocations per *
+ * run (unless --reps); returns them                                   */
+static inline int bench_prepare(bench_t* b, void* (*impl)(void* args),
+                                void* args)
+{
+  /* Locals of the timing macros */
+  timer_cfg_t  timer = *b->timer;
+  perf_group_t perf  = *b->perf;
+  uint64_t     ts, te;
+
+  b->reset(b->ctx);
+
+  if (b->warmup_ms > 0) {
+    bool settled;
+    if (b->verbose) printf("  * Warming up .... ");
+    uint32_t nwarmup = __WARMUP(impl, args, b->warmup_ms * 1e6, settled);
+    if (b->verbose) printf("Finished (%u invocations, %s)\n", nwarmup,
+                                    settled ? "settled" : "did not settle");
+  }
+
+  int reps = b->nreps;
+  if (reps <= 0) {
+    if (b->verbose) printf("  * Calibrating invocations per run (>= %d us) .... ",
+                                                               b->min_sample_us);
+    reps = __CALIBRATE_REPS(impl, args, b->min_sample_us * 1e3);
+    if (b->verbose) printf("Finished\n");
+  }
+  if (b->verbose) printf("    + Invocations per run = %d\n", reps);
+
+  return reps;
+}
+
+/* Time num_runs runs of pt->reps invocations into the sample buffers, *
+ * compute their statistics, counters and faults into pt and check the *
+ * output; returns the check. Unless verbose, only the faults that fail *
+ * --prefault are printed, so that sweeps keep one row per point.       */
+static inline bool bench_runs(bench_t* b, void* (*impl)(void* args),
+                              void* args, bench_point_t* pt)
+{
+  /* Locals of the timing macros */
+  timer_cfg_t  timer    = *b->timer;
+  perf_group_t perf     = *b->perf;
+  uint64_t*    counters = b->counters;
+  uint64_t     ts, te;
+
+  int reps = pt->reps;
+
+  if (b->verbose) printf("  * Invoking the implementation %d times .... ", b->num_runs);
+  faults_t faults;
+  faults_read(&faults);
+  for (uint32_t i = 0; i < b->num_runs; i++) {
+    b->runtimes[i] = __TIME_INVOCATIONS(impl, args, reps) / reps;
+    __CALC_COUNTERS(i, reps);
+  }
+  pt->faults = faults_since(&faults);
+  if (b->verbose) printf("Finished\n");
+
+  bool faulted = (pt->faults.minor != 0 || pt->faults.major != 0);
+  if (b->verbose || (b->prefault && faulted)) {
+    b->faults_failed |= !faults_check(&pt->faults, b->prefault);
+  }
+
+  stats_compute(&pt->stats, b->runtimes, b->runtimes_mask, b->num_runs, b->nstd);
+  perf_point(&perf, counters, b->runtimes_mask, b->num_runs, b->nelems,
+             &pt->counters);
+
+  pt->match = b->check(b->ctx);
+  if (b->verbose) printf("  * Verifying results .... %s\n",
+                                         pt->match ? "Success" : "Failed");
+
+  return pt->match;
+}
+
+/* Measure 'impl' on args from a clean output */
+static inline bench_point_t bench_measure(bench_t* b,
+                                          void* (*impl)(void* args),
+                                          void* args)
+{
+  bench_point_t pt;
+
+  pt.reps = bench_prepare(b, impl, args);
+  bench_runs(b, impl, args, &pt);
+
+  return pt;
+}
+
+/* Thread-scaling sweep of 'impl' from tmin to tmax threads, dumped to *
+ * threads_sweep.csv. set_threads() sets the thread count of args and  *
+ * the per-worker compute times (NULL when not recorded); speedup and   *
+ * efficiency are relative to tmin threads, and the imbalance is the    *
+ * slowest over the fastest worker.                                     */
+static inline void bench_threads_sweep(bench_t* b, void* (*impl)(void* args),
+                                       void* args,
+                                       void (*set_threads)(void* args, int nthreads,
+                                                           uint64_t* worker_ns),
+                                       int tmin, int tmax, const bench_rate_t* rate)
+{
+  printf("Running thread-scaling sweep from %d to %d threads:\n", tmin, tmax);
+
+  printf("  * Dumping sweep to threads_sweep.csv .... ");
+  FILE* fp = fopen("threads_sweep.csv", "w");
+  printf("%s\n", (fp != NULL) ? "Succeeded" : "Failed");
+
+  if (fp != NULL) {
+    fprintf(fp, "nthreads,invocations_per_run,median_ns,median_ci95_lo,"
+                "median_ci95_hi,%s,speedup,efficiency,"
+                "worker_fastest_ns,worker_slowest_ns,imbalance,check", rate->column);
+    perf_csv_header(fp, b->perf);
+    fprintf(fp, "\n");
+  }
+
+  printf("  %8s %14s %12s %9s %11s %14s %14s %10s %10s", "threads",
+         "median (ns)", rate->unit, "speedup", "efficiency", "fastest (ns)",
+         "slowest (ns)", "imbalance", "check");
+  perf_header(b->perf, "");
+  printf("\n");
+
+  uint64_t* worker_ns = (uint64_t*)calloc(tmax, sizeof(uint64_t));
+  double    base      = 0.0;
+
+  for (int t = tmin; t <= tmax; t++) {
+    set_threads(args, t, NULL);
+
+    bench_point_t pt;
+    pt.reps = bench_prepare(b, impl, args);
+
+    /* Workers accumulate their own compute time while being timed */
+    memset(worker_ns, 0, tmax * sizeof(uint64_t));
+    set_threads(args, t, worker_ns);
+
+    bench_runs(b, impl, args, &pt);
+
+    set_threads(args, t, NULL);
+
+    /* Mean compute time per invocation of the fastest and slowest workers */
+    double invocations = (double)b->num_runs * pt.reps;
+    double fastest     = -1.0;
+    double slowest     =  0.0;
+    for (int w = 0; w < t; w++) {
+      double w_ns = worker_ns[w] / invocations;
+      if (fastest < 0.0 || w_ns < fastest) fastest = w_ns;
+      if (w_ns > slowest)                  slowest = w_ns;
+    }
+    double imbalance = (fastest > 0.0) ? (slowest / fastest) : 0.0;
+
+    /* Speedup and efficiency relative to the first thread count */
+    if (t == tmin) base = pt.stats.median;
+    double speedup    = (pt.stats.median > 0.0) ? (base / pt.stats.median) : 0.0;
+    double efficiency = speedup * tmin / t;
+
+    printf("  %8d %14.1f %12.3f %8.2fx %10.1f%% %14.1f %14.1f %9.2fx %10s",
+           t, pt.stats.median, bench_rate(rate, pt.stats.median), speedup,
+           efficiency * 100.0, fastest, slowest, imbalance, __PRINT_MATCH(pt.match));
+    perf_row(b->perf, &pt.counters, "");
+    printf("\n");
+
+    if (fp != NULL) {
+      fprintf(fp, "%d,%d,%f,%f,%f,%f,%f,%f,%f,%f,%f,%s", t, pt.reps,
+                  pt.stats.median, pt.stats.ci_lo, pt.stats.ci_hi,
+                  bench_rate_per_sec(rate, pt.stats.median), speedup, efficiency,
+                  fastest, slowest, imbalance, __PRINT_MATCH(pt.match));
+      perf_csv_row(fp, b->perf, &pt.counters);
+      fprintf(fp, "\n");
+    }
+  }
+
+  if (fp != NULL) {
+    fclose(fp);
+  }
+  printf("\n");
+
+  free(worker_ns);
+}
+
+/* Offset sweep of the implementations sel[0..nsel): each of 'ngroups' *
+ * groups of buffers takes each of the offsets offs[0..noffs), in all   *
+ * combinations, dumped to offset_sweep.csv. place() moves the buffers  *
+ * of args to the offsets of the groups; the caller restores them.      */
+static inline void bench_offset_sweep(bench_t* b, const impl_t* impls,
+                                      const int* sel, int nsel, void* args,
+                                      const size_t* offs, int noffs,
+                                      int ngroups, const char* const* names,
+                                      void (*place)(void* ctx, const size_t* offs),
+                                      void* ctx, const bench_rate_t* rate)
+{
+  int ncombs = 1;
+  for (int g = 0; g < ngroups; g++) {
+    ncombs *= noffs;
+  }
+
+  printf("Running offset sweep over %d offset(s) per group (%d combination(s)):\n",
+                                                              noffs, ncombs);
+
+  printf("  * Dumping sweep to offset_sweep.csv .... ");
+  FILE* fp = fopen("offset_sweep.csv", "w");
+  printf("%s\n", (fp != NULL) ? "Succeeded" : "Failed");
+
+  if (fp != NULL) {
+    fprintf(fp, "impl,");
+    for (int g = 0; g < ngroups; g++) {
+      fprintf(fp, "%s_offset,", names[g]);
+    }
+    fprintf(fp, "invocations_per_run,median_ns,median_ci95_lo,median_ci95_hi,"
+                "%s,check", rate->column);
+    perf_csv_header(fp, b->perf);
+    fprintf(fp, "\n");
+  }
+
+  printf("  %-16s", "impl");
+  for (int g = 0; g < ngroups; g++) {
+    printf(" %7s", names[g]);
+  }
+  printf(" %14s %12s %10s %10s", "median (ns)", rate->unit, "vs first", "check");
+  perf_header(b->perf, "");
+  printf("\n");
+
+  /* Throughput of each implementation at the first combination */
+  double first_thr[nsel];
+  size_t o[ngroups];
+
+  for (int c = 0; c < ncombs; c++) {
+    /* The last group varies fastest */
+    for (int g = ngroups - 1, r = c; g >= 0; g--, r /= noffs) {
+      o[g] = offs[r % noffs];
+    }
+    place(ctx, o);
+
+    for (int k = 0; k < nsel; k++) {
+      const char*   impl_str = impls[sel[k]].str;
+      bench_point_t pt       = bench_measure(b, impls[sel[k]].fn, args);
+
+      double thr = bench_rate(rate, pt.stats.median);
+      if (c == 0) first_thr[k] = thr;
+
+      printf("  %-16s", impl_str);
+      for (int g = 0; g < ngroups; g++) {
+        printf(" %7zu", o[g]);
+      }
+      printf(" %14.1f %12.3f %9.2fx %10s", pt.stats.median, thr,
+             (first_thr[k] > 0.0) ? (thr / first_thr[k]) : 0.0,
+             __PRINT_MATCH(pt.match));
+      perf_row(b->perf, &pt.counters, "");
+      printf("\n");
+
+      if (fp != NULL) {
+        fprintf(fp, "%s,", impl_str);
+        for (int g = 0; g < ngroups; g++) {
+          fprintf(fp, "%zu,", o[g]);
+        }
+        fprintf(fp, "%d,%f,%f,%f,%f,%s", pt.reps, pt.stats.median,
+                    pt.stats.ci_lo, pt.stats.ci_hi,
+                    bench_rate_per_sec(rate, pt.stats.median),
+                    __PRINT_MATCH(pt.match));
+        perf_csv_row(fp, b->perf, &pt.counters);
+        fprintf(fp, "\n");
+      }
+    }
+  }
+
+  if (fp != NULL) {
+    fclose(fp);
+  }
+  printf("\n");
+}
+
+/* Interleaved A/B comparison of the implementations sel[0..nab) on *
+ * args: every round runs each of them once, in a fresh random order, *
+ * and the runtimes are compared in pairs against sel[0]. The rounds   *
+ * are dumped to ab_runtimes.csv.                                       */
+static inline void bench_ab(bench_t* b, const impl_t* impls, const int* sel,
+                            int nab, void* args)
+{
+  /* Locals of the timing macros */
+  timer_cfg_t  timer = *b->timer;
+  perf_group_t perf  = *b->perf;
+  uint64_t     ts, te;
+
+  uint32_t num_runs = b->num_runs;
+
+  printf("Running interleaved A/B comparison of %d implementations:\n", nab);
+
+  /* Warmup and calibrate every implementation on its own first */
+  int ab_reps[IMPL_MAX];
+  for (int a = 0; a < nab; a++) {
+    void* (*impl)(void* args) = impls[sel[a]].fn;
+
+    printf("  * Preparing \"%s\":\n", impls[sel[a]].str);
+    if (b->warmup_ms > 0) {
+      bool settled;
+      uint32_t nwarmup = __WARMUP(impl, args, b->warmup_ms * 1e6, settled);
+      printf("    + Warmup = %u invocations (%s)\n", nwarmup,
+                                  settled ? "settled" : "did not settle");
+    }
+
+    ab_reps[a] = b->nreps;
+    if (ab_reps[a] <= 0) {
+      ab_reps[a] = __CALIBRATE_REPS(impl, args, b->min_sample_us * 1e3);
+    }
+    printf("    + Invocations per run = %d\n", ab_reps[a]);
+  }
+
+  /* Every round runs each implementation once, in a fresh random order */
+  double*   ab_runtimes = (double*)calloc(nab * num_runs, sizeof(double));
+  uint64_t* ab_counters = (uint64_t*)calloc(nab * num_runs * PERF_MAX_COUNTERS,
+                                            sizeof(uint64_t));
+  uint64_t  ab_rng      = 0xdeadbeefllu;
+  int       order[IMPL_MAX];
+
+  for (int a = 0; a < nab; a++) {
+    order[a] = a;
+  }
+
+  printf("  * Invoking %d randomized rounds .... ", num_runs);
+  faults_t ab_faults;
+  faults_read(&ab_faults);
+  for (int i = 0; i < num_runs; i++) {
+    stats_shuffle(order, nab, &ab_rng);
+    for (int o = 0; o < nab; o++) {
+      int       a        = order[o];
+      uint64_t* counters = &ab_counters[a * num_runs * PERF_MAX_COUNTERS];
+
+      ab_runtimes[a * num_runs + i] =
+        __TIME_INVOCATIONS(impls[sel[a]].fn, args, ab_reps[a]) / ab_reps[a];
+      __CALC_COUNTERS(i, ab_reps[a]);
+    }
+  }
+  ab_faults = faults_since(&ab_faults);
+  printf("Finished\n");
+  b->faults_failed |= !faults_check(&ab_faults, b->prefault);
+
+  /* Verification, one clean invocation each */
+  bool ab_ok[IMPL_MAX];
+  for (int a = 0; a < nab; a++) {
+    b->reset(b->ctx);
+    (*impls[sel[a]].fn)(args);
+
+    ab_ok[a] = b->check(b->ctx);
+    printf("  * Verifying \"%s\" .... %s\n", impls[sel[a]].str,
+                                        ab_ok[a] ? "Success" : "Failed");
+  }
+
+  /* Paired comparison against the first implementation; the counters *
+   * are averaged over the rounds kept by the statistics of each one   */
+  stats_t      ab_stats[IMPL_MAX];
+  perf_point_t ab_perf [IMPL_MAX];
+  for (int a = 0; a < nab; a++) {
+    stats_compute(&ab_stats[a], &ab_runtimes[a * num_runs], b->runtimes_mask,
+                  num_runs, b->nstd);
+    perf_point(&perf, &ab_counters[a * num_runs * PERF_MAX_COUNTERS],
+               b->runtimes_mask, num_runs, b->nelems, &ab_perf[a]);
+  }
+
+  printf("  * Paired differences against \"%s\" (median %.1f ns):\n",
+                      impls[sel[0]].str, ab_stats[0].median);
+
+  stats_paired_t ab_paired[IMPL_MAX];
+  for (int a = 1; a < nab; a++) {
+    stats_paired(&ab_paired[a], &ab_runtimes[0], &ab_runtimes[a * num_runs],
+                 num_runs);
+
+    stats_paired_t* pr = &ab_paired[a];
+    printf("    + %s (%s):\n", impls[sel[a]].str, __PRINT_MATCH(ab_ok[a]));
+    printf("      - Median = %.1f ns (95%% CI [%.1f, %.1f])\n",
+           ab_stats[a].median, ab_stats[a].ci_lo, ab_stats[a].ci_hi);
+    printf("      - Paired difference: median = %+.1f ns, mean = %+.1f ns\n",
+           pr->median_diff, pr->mean_diff);
+    printf("      - Median paired ratio = %.4f\n", pr->median_ratio);
+    printf("      - Paired t-test: t = %.2f, p = %.3g\n", pr->t, pr->p_t);
+    printf("      - Wilcoxon signed-rank: z = %.2f, p = %.3g (%s at 5%%)\n",
+           pr->z_w, pr->p_w, (pr->p_w < 0.05) ? "significant" : "not significant");
+  }
+
+  if (perf.nevents > 0) {
+    printf("  * Performance counters of the rounds:\n");
+    printf("    %-16s", "impl");
+    perf_header(&perf, "");
+    printf("\n");
+    for (int a = 0; a < nab; a++) {
+      printf("    %-16s", impls[sel[a]].str);
+      perf_row(&perf, &ab_perf[a], "");
+      printf("\n");
+    }
+  }
+
+  /* Dump */
+  printf("  * Dumping A/B runtime informations:\n");
+  printf("    - Filename: ab_runtimes.csv\n");
+  printf("    - Opening file .... ");
+  FILE* fp = fopen("ab_runtimes.csv", "w");
+
+  if (fp != NULL) {
+    printf("Succeeded\n");
+    printf("    - Writing runtimes ... ");
+    fprintf(fp, "timer,%s", __timer_name(timer.src));
+
+    fprintf(fp, "\n");
+    fprintf(fp, "num_of_rounds,%d", num_runs);
+
+    for (int a = 0; a < nab; a++) {
+      fprintf(fp, "\n");
+      fprintf(fp, "%s", impls[sel[a]].str);
+      for (int i = 0; i < num_runs; i++) {
+        fprintf(fp, ", ");
+        fprintf(fp, "%.3f", ab_runtimes[a * num_runs + i]);
+      }
+    }
+
+    for (int a = 0; a < nab; a++) {
+      fprintf(fp, "\n");
+      fprintf(fp, "%s_median,%f", impls[sel[a]].str, ab_stats[a].median);
+    }
+
+    for (int a = 1; a < nab; a++) {
+      fprintf(fp, "\n");
+      fprintf(fp, "%s_paired_median_diff,%f", impls[sel[a]].str,
+                                              ab_paired[a].median_diff);
+      fprintf(fp, "\n");
+      fprintf(fp, "%s_wilcoxon_p,%g", impls[sel[a]].str, ab_paired[a].p_w);
+    }
+
+    for (int a = 0; a < nab; a++) {
+      for (int e = 0; e < perf.nevents; e++) {
+        fprintf(fp, "\n");
+        fprintf(fp, "%s_%s_per_elem,%f", impls[sel[a]].str,
+                    perf_ev_names[perf.event[e]], ab_perf[a].per_elem[e]);
+      }
+      if (ab_perf[a].ipc >= 0.0) {
+        fprintf(fp, "\n");
+        fprintf(fp, "%s_ipc,%f", impls[sel[a]].str, ab_perf[a].ipc);
+      }
+    }
+    printf("Finished\n");
+    printf("    - Closing file handle .... ");
+    fclose(fp);
+    printf("Finished\n");
+  } else {
+    printf("Failed\n");
+  }
+  printf("\n");
+
+  free(ab_runtimes);
+  free(ab_counters);
+}
+
+#endif //__COMMON_BENCH_H_
@@ -0,0 +1,76 @@
+/* faults.h
+ *
+ * Author: Khalid Al-Hawaj
+ * Date  : 16 Oct. 2026
+ *
+ * This file contains the page-fault accounting of the measured runs and
+ * the memory locking of the prefault mode. Faults are read with
+ * getrusage(RUSAGE_SELF), which covers all threads of the process, right
+ * before and after the timed loop. With --prefault, every buffer is
+ * populated when it is mapped (or touched when it is initialized), the
+ * whole address space is locked with mlockall() (failing to lock is
+ * fatal), and any fault in a timed loop fails the run.
+*/
+
+#ifndef __COMMON_FAULTS_H_
+#define __COMMON_FAULTS_H_
+
+/* Standard C includes */
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <sys/resource.h>
+#include <sys/mman.h>
+
+typedef struct {
+  uint64_t minor;
+  uint64_t major;
+} faults_t;
+
+static inline void faults_read(faults_t* f)
+{
+  struct rusage ru;
+
+  if (getrusage(RUSAGE_SELF, &ru) != 0) {
+    f->minor = 0;
+    f->major = 0;
+    return;
+  }
+
+  f->minor = (uint64_t)ru.ru_minflt;
+  f->major = (uint64_t)ru.ru_majflt;
+}
+
+/* Faults since 'start' */
+static inline faults_t faults_since(const faults_t* start)
+{
+  faults_t now;
+  faults_read(&now);
+
+  now.minor -= start->minor;
+  now.major -= start->major;
+
+  return now;
+}
+
+/* Lock everything mapped now and in the future; returns false if the *
+ * kernel refused (e.g. RLIMIT_MEMLOCK).                             */
+static inline bool faults_lock(void)
+{
+  return mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+}
+
+/* Print the faults of a measured loop; returns false if there were  *
+ * any and they are not allowed.                                      */
+static inline bool faults_check(const faults_t* f, bool prefault)
+{
+  bool ok = !prefault || (f->minor == 0 && f->major == 0);
+
+  printf("  * Page faults during the runs: minor = %" PRIu64 ", major = %" PRIu64
+         "%s\n", f->minor, f->major, ok ? "" : " .... Failed (--prefault)");
+
+  return ok;
+}
+
+#endif //__COMMON_FAULTS_H_
@@ -0,0 +1,93 @@
+/* impl.h
+ *
+ * Author: Khalid Al-Hawaj
+ * Date  : 16 Oct. 2026
+ *
+ * This file contains the implementation table shared by the harnesses.
+ * Each benchmark lists its implementations once; the '-i' argument then
+ * selects one of them, a comma-separated list (e.g. "opt,vec") or all
+ * of them ("all"), and every selected implementation is run against the
+ * same input buffers within one process.
+*/
+
+#ifndef __COMMON_IMPL_H_
+#define __COMMON_IMPL_H_
+
+/* Standard C includes */
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+
+/* Maximum number of implementations in a table */
+#define IMPL_MAX 64
+
+typedef struct {
+  const char* name;              /* name on the command line */
+  const char* str;               /* name in reports and file names */
+  void*     (*fn)(void* args);
+} impl_t;
+
+/* Parse an implementation selection; returns false and leaves the *
+ * offending name in 'bad' if a name is unknown.                    */
+static inline bool impl_parse(const impl_t* impls, int nimpls,
+                              const char* spec, int* sel, int* nsel,
+                              char* bad, size_t bad_len)
+{
+  char buf[256];
+  strncpy(buf, spec, sizeof(buf) - 1);
+  buf[sizeof(buf) - 1] = '\0';
+
+  *nsel = 0;
+  for (char* tok = strtok(buf, ","); tok != NULL; tok = strtok(NULL, ",")) {
+    if (strcmp(tok, "all") == 0) {
+      for (int k = 0; k < nimpls && *nsel < IMPL_MAX; k++) {
+        sel[(*nsel)++] = k;
+      }
+      continue;
+    }
+
+    int found = -1;
+    for (int k = 0; k < nimpls; k++) {
+      if (strcmp(tok, impls[k].name) == 0) { found = k; break; }
+    }
+
+    if (found < 0 || *nsel >= IMPL_MAX) {
+      snprintf(bad, bad_len, "%s", tok);
+      *nsel = 0;
+      return false;
+    }
+
+    sel[(*nsel)++] = found;
+  }
+
+  return (*nsel > 0);
+}
+
+/* Print the names of all implementations, comma separated */
+static inline void impl_print_names(const impl_t* impls, int nimpls)
+{
+  for (int k = 0; k < nimpls; k++) {
+    printf("%s%s", (k == 0) ? "" : ", ", impls[k].name);
+  }
+}
+
+/* Print the comparison table. 'work' is the amount of work done by *
+ * one invocation, and 'scale' converts work/ns into 'unit'. The     *
+ * speedup is relative to the first selected implementation.         */
+static inline void impl_summary(const impl_t* impls, const int* sel, int nsel,
+                                const double* medians, const bool* matches,
+                                double work, double scale, const char* unit)
+{
+  printf("Summary (speedup over \"%s\"):\n", impls[sel[0]].str);
+  printf("  %-24s %16s %14s %10s %10s\n", "impl", "median (ns)", unit,
+                                          "speedup", "check");
+  for (int k = 0; k < nsel; k++) {
+    double thr = (medians[k] > 0.0) ? (work / medians[k] * scale) : 0.0;
+    double spd = (medians[k] > 0.0) ? (medians[0] / medians[k]) : 0.0;
+    printf("  %-24s %16.1f %14.3f %9.2fx %10s\n", impls[sel[k]].str,
+                  medians[k], thr, spd, matches[k] ? "MATCHING" : "MISMATCH");
+  }
+  printf("\n");
+}
+
+#endif //__COMMON_IMPL_H_
@@ -40,8 +40,8 @@ static inline int
 CPU_ISSET(int num, cpu_set_t *cs) { return (cs->count & (1 << num)); }
 
 /* pthreads functions */
-int pthread_setaffinity_np(pthread_t thread, size_t cpu_size,
-                           cpu_set_t *cpu_set)
+static inline int pthread_setaffinity_np(pthread_t thread, size_t cpu_size,
+                                         cpu_set_t *cpu_set)
 {
   thread_port_t mach_thread;
   int core = 0;
@@ -16,26 +16,24 @@
 #define __PRINT_MATCH(x) (x ? "MATCHING" : "MISMATCH")
 
 /* Testing and Statistics Macros */
-#ifndef __APPLE__
+/* Sizes are size_t throughout; a request whose size in bytes does not  *
+ * fit in size_t is fatal. Large ones (or all of them, with huge pages) *
+ * are mapped by the arena.                                             */
 #define __ALLOC_DATA(type, nelems) ({                  \
-  unsigned int nbytes = (nelems) * sizeof(type);       \
-  type* temp = (type*)aligned_alloc(512 / 8, nbytes);  \
-                                                       \
-  if (temp == NULL) {                                  \
+  size_t nelems_ = (size_t)(nelems);                   \
+  if (nelems_ > (SIZE_MAX - 63) / sizeof(type)) {      \
     printf("\n");                                      \
-    printf("  ERROR: Cannot allocate memory!");        \
+    printf("  ERROR: Allocation size overflows!");     \
     printf("\n");                                      \
     printf("\n");                                      \
     exit(-2);                                          \
   }                                                    \
                                                        \
-  temp;                                                \
-})
-#else
-#define __ALLOC_DATA(type, nelems) ({                  \
-  unsigned int nbytes = (nelems) * sizeof(type);       \
+  size_t nbytes = nelems_ * sizeof(type);              \
   nbytes = ((nbytes + 63) / 64) * 64;                  \
-  type* temp = (type*)aligned_alloc(512 / 8, nbytes);  \
+  type* temp = arena_wants(nbytes)                     \
+             ? (type*)arena_alloc(nbytes)              \
+             : (type*)aligned_alloc(512 / 8, nbytes);  \
                                                        \
   if (temp == NULL) {                                  \
     printf("\n");                                      \
@@ -47,48 +45,27 @@
                                                        \
   temp;                                                \
 })
-#endif
 
-#ifndef __APPLE__
-#define __ALLOC_INIT_DATA(type, nelems) ({             \
-  unsigned int nbytes = (nelems) * sizeof(type);       \
-  type* temp = (type*)aligned_alloc(512 / 8, nbytes);  \
-                                                       \
-  if (temp == NULL) {                                  \
-    printf("\n");                                      \
-    printf("  ERROR: Cannot allocate memory!");        \
-    printf("\n");                                      \
-    printf("\n");                                      \
-    exit(-2);                                          \
-  }                                                    \
-                                                       \
-  /* Generate data */                                  \
-  for(int i = 0; i < nelems; i++) {                    \
-    temp[i] = rand() % (0x1llu << (sizeof(type) * 8)); \
-  }                                                    \
-  temp;                                                \
-})
-#else
-#define __ALLOC_INIT_DATA(type, nelems) ({             \
-  unsigned int nbytes = (nelems) * sizeof(type);       \
-  nbytes = ((nbytes + 63) / 64) * 64;                  \
-  type* temp = (type*)aligned_alloc(512 / 8, nbytes);  \
-                                                       \
-  if (temp == NULL) {                                  \
-    printf("\n");                                      \
-    printf("  ERROR: Cannot allocate memory!");        \
-    printf("\n");                                      \
-    printf("\n");                                      \
-    exit(-2);                                          \
+#define __FREE_DATA(array) {                           \
+  if (!arena_free(array)) {                            \
+    free(array);                                       \
   }                                                    \
+}
+
+/* Initialize an allocated array (e.g. after placing its pages) with *
+ * one stream of the counter-based generator (common/rng.h)           */
+#define __INIT_DATA(type, array, nelems, stream) {     \
+  rng_fill(array, 0, (size_t)(nelems) * sizeof(type),  \
+           RNG_SEED, stream);                          \
+}
+
+#define __ALLOC_INIT_DATA(type, nelems, stream) ({     \
+  type* temp = __ALLOC_DATA(type, nelems);             \
                                                        \
   /* Generate data */                                  \
-  for(int i = 0; i < nelems; i++) {                    \
-    temp[i] = rand() % (0x1llu << (sizeof(type) * 8)); \
-  }                                                    \
+  __INIT_DATA(type, temp, nelems, stream);             \
   temp;                                                \
 })
-#endif
 
 #define __SET_GUARD(array, sz) {                       \
   ((byte*)array)[sz + 0] = 0xfe;                       \
@@ -100,7 +77,7 @@
 #define __CHECK_MATCH(ref, array, sz) ({               \
   bool __tmp = true;                                   \
                                                        \
-  for(int i = 0; (i < sz) && __tmp; i++) {             \
+  for(size_t i = 0; (i < (size_t)(sz)) && __tmp; i++) {\
     __tmp = __tmp && (ref[i] == array[i]);             \
   }                                                    \
                                                        \
@@ -110,7 +87,7 @@
 #define __CHECK_FLOAT_MATCH(ref, array, sz, delta) ({  \
   bool __tmp = true;                                   \
                                                        \
-  for(int i = 0; (i < sz) && __tmp; i++) {             \
+  for(size_t i = 0; (i < (size_t)(sz)) && __tmp; i++) {\
     __tmp = __tmp && (fabs(ref[i] - array[i]) < delta);\
   }                                                    \
                                                        \
@@ -130,46 +107,136 @@
 
 #define __DECLARE_STATS(_num_runs, _num_stdev)         \
   /* Time keeping */                                   \
-  struct timespec ts;                                  \
-  struct timespec te;                                  \
+  uint64_t ts;                                         \
+  uint64_t te;                                         \
                                                        \
-  /* Iterate and average runtimes */                   \
+  /* Iterate and average runtimes; per invocation, in  \
+   * ns, with the fraction the reps average resolves */ \
   uint32_t num_runs = _num_runs;                       \
-  uint64_t* runtimes;                                  \
+  double* runtimes;                                    \
   bool* runtimes_mask;                                 \
                                                        \
-  runtimes = (uint64_t*)calloc(num_runs,               \
-                                 sizeof(uint64_t));    \
+  runtimes = (double*)calloc(num_runs,                 \
+                               sizeof(double));        \
                                                        \
   runtimes_mask = (bool*)calloc(num_runs,              \
                                      sizeof(bool));    \
                                                        \
+  /* Performance counters, next to runtimes */         \
+  uint64_t* counters;                                  \
+                                                       \
+  counters = (uint64_t*)calloc(num_runs *              \
+                                 PERF_MAX_COUNTERS,    \
+                                 sizeof(uint64_t));    \
+                                                       \
   /* Constants for statistical analysis */             \
   const unsigned int nstd = _num_stdev;
 
 #define __DESTROY_STATS()                              \
   free(runtimes);                                      \
-  free(runtimes_mask);
+  free(runtimes_mask);                                 \
+  free(counters);                                      \
+  perf_close(&perf);
 
 #define __SET_START_TIME() {                           \
   __COMPILER_FENCE_;                                   \
-  if (clock_gettime(CLOCK_MONOTONIC, &ts) == -1) {     \
-    printf("\n\n    ERROR: getting time failed!\n\n"); \
-    exit(-1);                                          \
+  if (perf.nevents > 0) {                              \
+    perf_read(&perf, perf.start);                      \
   }                                                    \
+  ts = timer_start(&timer);                            \
+  __COMPILER_FENCE_;                                   \
 }
 
 #define __SET_END_TIME() {                             \
   __COMPILER_FENCE_;                                   \
-  if (clock_gettime(CLOCK_MONOTONIC, &te) == -1) {     \
-    printf("\n\n    ERROR: getting time failed!\n\n"); \
-    exit(-1);                                          \
+  te = timer_stop(&timer);                             \
+  if (perf.nevents > 0) {                              \
+    perf_read(&perf, perf.end);                        \
   }                                                    \
+  __COMPILER_FENCE_;                                   \
 }
 
 #define __CALC_RUNTIME() ({                            \
-    (((te.tv_sec  - ts.tv_sec ) * 1e9) +               \
-      (te.tv_nsec - ts.tv_nsec)      ) ;               \
+    timer_elapsed_ns(&timer, ts, te);                  \
+})
+
+/* Time 'reps' back-to-back invocations of 'impl' and return the  *
+ * elapsed time of the whole sample in nanoseconds.               */
+#define __TIME_INVOCATIONS(impl, args, reps) ({         \
+  __SET_START_TIME();                                  \
+  for (uint32_t __j = 0; __j < (reps); __j++) {        \
+    (*(impl))(args);                                   \
+  }                                                    \
+  __SET_END_TIME();                                    \
+  __CALC_RUNTIME();                                    \
 })
 
+/* Invoke 'impl' in windows of 8 until the median of a window is  *
+ * within 2% (or 1 ns) of the previous one, or until 'max_ns' is  *
+ * spent. Returns the number of warmup invocations.               */
+#define __WARMUP(impl, args, max_ns, settled) ({        \
+  double   __prev  = -1.0;                             \
+  double   __spent =  0.0;                             \
+  uint32_t __n     =  0;                               \
+                                                       \
+  settled = false;                                     \
+  while (!settled && __spent < (max_ns)) {             \
+    double __win[8];                                   \
+    for (int __k = 0; __k < 8; __k++) {                \
+      __win[__k] = __TIME_INVOCATIONS(impl, args, 1);  \
+      __spent   += __win[__k];                         \
+      __n       += 1;                                  \
+    }                                                  \
+                                                       \
+    for (int __a = 1; __a < 8; __a++) {                \
+      for (int __b = __a; __b > 0 &&                   \
+                 __win[__b - 1] > __win[__b]; __b--) { \
+        double __t = __win[__b];                       \
+        __win[__b] = __win[__b - 1];                   \
+        __win[__b - 1] = __t;                          \
+      }                                                \
+    }                                                  \
+                                                       \
+    double __med = (__win[3] + __win[4]) / 2.0;        \
+    double __tol = fmax(0.02 * __prev, 1.0);           \
+    settled = (__prev >= 0.0) &&                       \
+              (fabs(__med - __prev) <= __tol);         \
+    __prev  = __med;                                   \
+  }                                                    \
+                                                       \
+  __n;                                                 \
+})
+
+/* Find the smallest number of back-to-back invocations whose     *
+ * sample takes at least 'min_ns' (best of 3 samples).            */
+#define __CALIBRATE_REPS(impl, args, min_ns) ({         \
+  uint32_t __reps = 1;                                 \
+                                                       \
+  while (__reps < (1u << 24)) {                        \
+    double __best = -1.0;                              \
+    for (int __k = 0; __k < 3; __k++) {                \
+      double __t = __TIME_INVOCATIONS(impl, args,      \
+                                      __reps);         \
+      if (__best < 0.0 || __t < __best) __best = __t;  \
+    }                                                  \
+                                                       \
+    if (__best >= (min_ns)) break;                     \
+                                                       \
+    uint32_t __next = (__best > 0.0)                   \
+      ? (uint32_t)ceil(__reps * ((min_ns) / __best))   \
+      : (__reps * 2);                                  \
+    __reps = (__next > __reps) ? __next : (__reps + 1);\
+  }                                                    \
+                                                       \
+  __reps;                                              \
+})
+
+#define __CALC_COUNTERS(run, ninvocations) {           \
+  for (int __k = 0; __k < perf.nevents; __k++) {       \
+    counters[(run) * PERF_MAX_COUNTERS + __k] =        \
+      (perf.end[__k] - perf.start[__k]) /              \
+                                      (ninvocations);  \
+  }                                                    \
+}
+
 #endif //__COMMON_MACROS_H_
@@ -0,0 +1,264 @@
+/* numa.h
+ *
+ * Author: Khalid Al-Hawaj
+ * Date  : 16 Oct. 2026
+ *
+ * This file contains the NUMA placement of the datasets, without libnuma.
+ * A buffer is split into the same slices the parallel implementations
+ * use (nworkers equal slices, the last one taking the remainder), and
+ * its pages are placed with one of the following policies:
+ *
+ *   firsttouch: each pinned worker writes its own slice before the data
+ *               is generated, so the kernel backs it on the worker's node
+ *   interleave: mbind(MPOL_INTERLEAVE) over all nodes in use
+ *   local     : mbind(MPOL_BIND) of each slice to the node of the worker
+ *               that owns it, moving the pages that are already present
+ *
+ * Policies apply to whole pages: the buffer is rounded out to pages, and
+ * a page shared by two slices goes to the lower one, so that every page
+ * of the buffer gets a policy.
+ *
+ * After placement, move_pages() (with no target nodes) reports where the
+ * pages actually are: per node, and the fraction that is local to the
+ * worker owning it. Large buffers are sampled.
+*/
+
+#ifndef __COMMON_NUMA_H_
+#define __COMMON_NUMA_H_
+
+/* Standard C includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+/* Include common headers */
+#include "common/types.h"
+#include "common/topo.h"
+#include "common/pool.h"
+
+/* Limits */
+#define NUMA_MAX_NODES   64
+#define NUMA_MAX_SAMPLES (1 << 16)
+
+/* Memory policies (from linux/mempolicy.h) */
+#define __NUMA_MPOL_BIND       2
+#define __NUMA_MPOL_INTERLEAVE 3
+#define __NUMA_MPOL_MF_MOVE    (1 << 1)
+
+/* NUMA modes */
+typedef enum {
+  NUMA_NONE = 0,
+  NUMA_FIRSTTOUCH,
+  NUMA_INTERLEAVE,
+  NUMA_LOCAL
+} numa_mode_t;
+
+static const char* const numa_names[] = {
+  "none", "firsttouch", "interleave", "local"
+};
+
+static inline bool numa_parse(numa_mode_t* m, const char* str)
+{
+  for (int k = 0; k < (int)(sizeof(numa_names) / sizeof(numa_names[0])); k++) {
+    if (strcasecmp(str, numa_names[k]) == 0) { *m = (numa_mode_t)k; return true; }
+  }
+
+  return false;
+}
+
+/* Slice of worker w, in bytes; slices are whole elements */
+static inline void numa_slice(size_t nbytes, size_t elem, int nworkers, int w,
+                              size_t* off, size_t* len)
+{
+  size_t nelems = nbytes / elem;
+  size_t per    = nelems / nworkers;
+
+  *off = (size_t)w * per * elem;
+  *len = (w == nworkers - 1) ? (nbytes - *off) : (per * elem);
+}
+
+static inline long __numa_mbind(void* addr, size_t len, int mode,
+                                const unsigned long* mask, unsigned flags)
+{
+#if defined(__linux__) && defined(SYS_mbind)
+  return syscall(SYS_mbind, addr, len, mode, mask, NUMA_MAX_NODES + 1, flags);
+#else
+  (void)addr; (void)len; (void)mode; (void)mask; (void)flags;
+  return -1;
+#endif
+}
+
+/* Pages of slice w of [buf, buf + nbytes): the first slice starts at *
+ * the page of the buffer's first byte, every slice ends at the page   *
+ * of its last byte, and the next slice starts after it                */
+static inline bool __numa_pages(void* buf, size_t nbytes, size_t elem,
+                                int nworkers, int w, void** p_addr,
+                                size_t* p_len)
+{
+  size_t off, sz;
+  numa_slice(nbytes, elem, nworkers, w, &off, &sz);
+
+  uintptr_t psz   = (uintptr_t)sysconf(_SC_PAGESIZE);
+  uintptr_t start = (uintptr_t)buf + off;
+  uintptr_t lo    = (w == 0) ? (start & ~(psz - 1))
+                             : ((start + psz - 1) & ~(psz - 1));
+  uintptr_t hi    = (start + sz + psz - 1) & ~(psz - 1);
+
+  if (hi <= lo) return false;
+
+  *p_addr = (void*)lo;
+  *p_len  = hi - lo;
+  return true;
+}
+
+/* First touch */
+typedef struct {
+  byte*  base;
+  size_t len;
+} __numa_touch_t;
+
+static void* __numa_touch(void* arg)
+{
+  __numa_touch_t* t = (__numa_touch_t*)arg;
+  memset(t->base, 0, t->len);
+
+  return NULL;
+}
+
+/* Place the pages of one buffer; the caller must not have touched them *
+ * yet for firsttouch. Returns false if the kernel refused the policy.  */
+static inline bool numa_place(numa_mode_t mode, const topo_t* topo,
+                              pool_t* pool, const int* cpus, int nworkers,
+                              void* buf, size_t nbytes, size_t elem)
+{
+  void*  addr;
+  size_t len;
+
+  switch (mode) {
+    case NUMA_FIRSTTOUCH: {
+      __numa_touch_t touch[nworkers];
+      void*          targs[nworkers];
+      for (int w = 0; w < nworkers; w++) {
+        size_t off, sz;
+        numa_slice(nbytes, elem, nworkers, w, &off, &sz);
+        touch[w] = (__numa_touch_t){ .base = (byte*)buf + off, .len = sz };
+        targs[w] = &touch[w];
+      }
+
+      /* Use the workers' pool; without one, start one just for this */
+      return pool_run_once(pool, cpus, __numa_touch, targs, nworkers);
+    }
+
+    case NUMA_INTERLEAVE: {
+      unsigned long mask[NUMA_MAX_NODES / 64] = { 0 };
+      for (int w = 0; w < nworkers; w++) {
+        const topo_cpu_t* p = topo_find(topo, cpus[w]);
+        int node = (p != NULL) ? p->node : 0;
+        if (node < NUMA_MAX_NODES) mask[node / 64] |= 1lu << (node % 64);
+      }
+
+      if (!__numa_pages(buf, nbytes, elem, 1, 0, &addr, &len)) return true;
+      return __numa_mbind(addr, len, __NUMA_MPOL_INTERLEAVE, mask,
+                                          __NUMA_MPOL_MF_MOVE) == 0;
+    }
+
+    case NUMA_LOCAL: {
+      bool ok = true;
+      for (int w = 0; w < nworkers; w++) {
+        const topo_cpu_t* p = topo_find(topo, cpus[w]);
+        int node = (p != NULL) ? p->node : 0;
+
+        unsigned long mask[NUMA_MAX_NODES / 64] = { 0 };
+        if (node < NUMA_MAX_NODES) mask[node / 64] |= 1lu << (node % 64);
+
+        if (!__numa_pages(buf, nbytes, elem, nworkers, w, &addr, &len)) continue;
+
+        ok = ok && (__numa_mbind(addr, len, __NUMA_MPOL_BIND, mask,
+                                          __NUMA_MPOL_MF_MOVE) == 0);
+      }
+      return ok;
+    }
+
+    case NUMA_NONE:
+    default:
+      return true;
+  }
+}
+
+/* Print the node of the (sampled) pages of a buffer, and how many of *
+ * them are local to the worker that owns their slice.               */
+static inline void numa_report(const char* name, const topo_t* topo,
+                               const int* cpus, int nworkers,
+                               const void* buf, size_t nbytes, size_t elem)
+{
+#if defined(__linux__) && defined(SYS_move_pages)
+  size_t    psz    = (size_t)sysconf(_SC_PAGESIZE);
+  uintptr_t base   = (uintptr_t)buf & ~(uintptr_t)(psz - 1);
+  size_t    npages = ((uintptr_t)buf + nbytes - base + psz - 1) / psz;
+  size_t    stride = (npages + NUMA_MAX_SAMPLES - 1) / NUMA_MAX_SAMPLES;
+  if (stride == 0) stride = 1;
+
+  size_t on_node[NUMA_MAX_NODES] = { 0 };
+  size_t sampled = 0, local = 0, absent = 0;
+
+  enum { BATCH = 1024 };
+  void*  pages [BATCH];
+  int    status[BATCH];
+  int    owner [BATCH];
+
+  for (size_t pg = 0; pg < npages; ) {
+    int n = 0;
+    for (; n < BATCH && pg < npages; n++, pg += stride) {
+      uintptr_t a   = base + pg * psz;
+      uintptr_t off = (a > (uintptr_t)buf) ? (a - (uintptr_t)buf) : 0;
+
+      /* Owner of the page: the worker whose slice contains it */
+      owner[n] = nworkers - 1;
+      for (int w = 0; w < nworkers; w++) {
+        size_t o, sz;
+        numa_slice(nbytes, elem, nworkers, w, &o, &sz);
+        if (off < o + sz) { owner[n] = w; break; }
+      }
+      pages[n] = (void*)a;
+    }
+
+    if (syscall(SYS_move_pages, 0, n, pages, NULL, status, 0) != 0) {
+      printf("    + %-6s: move_pages failed\n", name);
+      return;
+    }
+
+    for (int i = 0; i < n; i++) {
+      sampled++;
+      if (status[i] < 0 || status[i] >= NUMA_MAX_NODES) { absent++; continue; }
+
+      on_node[status[i]]++;
+
+      const topo_cpu_t* p = topo_find(topo, cpus[owner[i]]);
+      if (p != NULL && p->node == status[i]) local++;
+    }
+  }
+
+  printf("    + %-6s:", name);
+  for (int n = 0; n < NUMA_MAX_NODES; n++) {
+    if (on_node[n] > 0) {
+      printf(" node%d %5.1f%%,", n, 100.0 * on_node[n] / sampled);
+    }
+  }
+  if (absent > 0) printf(" not present %5.1f%%,", 100.0 * absent / sampled);
+  printf(" local to owner %5.1f%% (%zu page(s)%s)\n",
+            100.0 * local / sampled, sampled, (stride > 1) ? ", sampled" : "");
+#else
+  (void)topo; (void)cpus; (void)nworkers; (void)buf; (void)nbytes; (void)elem;
+  printf("    + %-6s: page placement is not available\n", name);
+#endif
+}
+
+#endif //__COMMON_NUMA_H_
@@ -0,0 +1,410 @@
+/* perf.h
+ *
+ * Author: Khalid Al-Hawaj
+ * Date  : 16 Oct. 2026
+ *
+ * This file contains a thin wrapper around the Linux perf_event_open()
+ * system call. The requested hardware counters are opened as a single
+ * group, so they are enabled, disabled and read atomically with one
+ * read() on the group leader. The counters are inherited by threads
+ * spawned after the group is opened, so parallel implementations are
+ * accounted for as well.
+ *
+ * Supported counters:
+ *
+ *   cycles, instructions, llc-misses, branch-misses, dtlb-misses,
+ *   page-faults, context-switches
+ *
+ * On Darwin, or whenever the kernel refuses to open a counter, the
+ * group simply ends up with fewer (or no) events; the harness keeps
+ * running with wall-clock time only.
+*/
+
+#ifndef __COMMON_PERF_H_
+#define __COMMON_PERF_H_
+
+/* Standard C includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdbool.h>
+#include <inttypes.h>
+
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+/* Maximum number of counters in one group */
+#define PERF_MAX_COUNTERS 8
+
+/* Supported events */
+typedef enum {
+  PERF_EV_CYCLES = 0,
+  PERF_EV_INSTRUCTIONS,
+  PERF_EV_LLC_MISSES,
+  PERF_EV_BRANCH_MISSES,
+  PERF_EV_DTLB_MISSES,
+  PERF_EV_PAGE_FAULTS,
+  PERF_EV_CONTEXT_SWITCHES,
+  PERF_EV_COUNT
+} perf_ev_t;
+
+static const char* const perf_ev_names[PERF_EV_COUNT] = {
+  "cycles",
+  "instructions",
+  "llc-misses",
+  "branch-misses",
+  "dtlb-misses",
+  "page-faults",
+  "context-switches"
+};
+
+/* Counter group */
+typedef struct {
+  int       nevents;
+  perf_ev_t event[PERF_MAX_COUNTERS];
+  int       fd   [PERF_MAX_COUNTERS];
+
+  /* Snapshots taken at the start and the end of a timed window */
+  uint64_t  start[PERF_MAX_COUNTERS];
+  uint64_t  end  [PERF_MAX_COUNTERS];
+} perf_group_t;
+
+/* Counters of one measured point, as columns of a table */
+typedef struct {
+  double per_elem[PERF_MAX_COUNTERS];
+  double ipc;           /* < 0 without cycles and instructions */
+} perf_point_t;
+
+static inline void perf_init(perf_group_t* g)
+{
+  g->nevents = 0;
+  for (int i = 0; i < PERF_MAX_COUNTERS; i++) {
+    g->fd   [i] = -1;
+    g->start[i] =  0;
+    g->end  [i] =  0;
+  }
+}
+
+static inline int perf_find(const perf_group_t* g, perf_ev_t ev)
+{
+  for (int i = 0; i < g->nevents; i++) {
+    if (g->event[i] == ev) return i;
+  }
+  return -1;
+}
+
+/* Parse a comma-separated list of counter names; returns false and *
+ * leaves the offending name in 'bad' if the name is unknown.       */
+static inline bool perf_parse(perf_group_t* g, const char* spec,
+                              char* bad, size_t bad_len)
+{
+  char buf[256];
+  strncpy(buf, spec, sizeof(buf) - 1);
+  buf[sizeof(buf) - 1] = '\0';
+
+  for (char* tok = strtok(buf, ","); tok != NULL; tok = strtok(NULL, ",")) {
+    int ev = -1;
+    for (int e = 0; e < PERF_EV_COUNT; e++) {
+      if (strcasecmp(tok, perf_ev_names[e]) == 0) { ev = e; break; }
+    }
+
+    if (ev < 0 || g->nevents >= PERF_MAX_COUNTERS) {
+      snprintf(bad, bad_len, "%s", tok);
+      return false;
+    }
+
+    if (perf_find(g, (perf_ev_t)ev) < 0) {
+      g->event[g->nevents++] = (perf_ev_t)ev;
+    }
+  }
+
+  return true;
+}
+
+#if defined(__linux__)
+static inline void perf_attr(struct perf_event_attr* attr, perf_ev_t ev)
+{
+  memset(attr, 0, sizeof(*attr));
+  attr->size = sizeof(*attr);
+
+  switch (ev) {
+    case PERF_EV_CYCLES:
+      attr->type   = PERF_TYPE_HARDWARE;
+      attr->config = PERF_COUNT_HW_CPU_CYCLES;
+      break;
+    case PERF_EV_INSTRUCTIONS:
+      attr->type   = PERF_TYPE_HARDWARE;
+      attr->config = PERF_COUNT_HW_INSTRUCTIONS;
+      break;
+    case PERF_EV_LLC_MISSES:
+      attr->type   = PERF_TYPE_HARDWARE;
+      attr->config = PERF_COUNT_HW_CACHE_MISSES;
+      break;
+    case PERF_EV_BRANCH_MISSES:
+      attr->type   = PERF_TYPE_HARDWARE;
+      attr->config = PERF_COUNT_HW_BRANCH_MISSES;
+      break;
+    case PERF_EV_DTLB_MISSES:
+      attr->type   = PERF_TYPE_HW_CACHE;
+      attr->config = (PERF_COUNT_HW_CACHE_DTLB                ) |
+                     (PERF_COUNT_HW_CACHE_OP_READ        <<  8) |
+                     (PERF_COUNT_HW_CACHE_RESULT_MISS    << 16);
+      break;
+    case PERF_EV_PAGE_FAULTS:
+      attr->type   = PERF_TYPE_SOFTWARE;
+      attr->config = PERF_COUNT_SW_PAGE_FAULTS;
+      break;
+    case PERF_EV_CONTEXT_SWITCHES:
+      attr->type   = PERF_TYPE_SOFTWARE;
+      attr->config = PERF_COUNT_SW_CONTEXT_SWITCHES;
+      break;
+    default:
+      break;
+  }
+
+  attr->read_format    = PERF_FORMAT_GROUP;
+  attr->inherit        = 1;
+
+  /* Software events are accounted by the kernel itself */
+  if (attr->type != PERF_TYPE_SOFTWARE) {
+    attr->exclude_kernel = 1;
+    attr->exclude_hv     = 1;
+  }
+}
+#endif
+
+/* Open all parsed events as one group. Events the kernel refuses are *
+ * dropped from the group. Returns the number of events left.         */
+static inline int perf_open(perf_group_t* g)
+{
+#if defined(__linux__)
+  int nopen = 0;
+
+  for (int i = 0; i < g->nevents; i++) {
+    struct perf_event_attr attr;
+    perf_attr(&attr, g->event[i]);
+
+    int leader = (nopen == 0) ? -1 : g->fd[0];
+    int fd = syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+
+    printf("    - %-16s .... %s\n", perf_ev_names[g->event[i]],
+                                  (fd < 0) ? "Failed" : "Succeeded");
+
+    if (fd >= 0) {
+      g->event[nopen] = g->event[i];
+      g->fd   [nopen] = fd;
+      nopen++;
+    }
+  }
+  g->nevents = nopen;
+
+  if (nopen > 0) {
+    ioctl(g->fd[0], PERF_EVENT_IOC_RESET , PERF_IOC_FLAG_GROUP);
+    ioctl(g->fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+
+  return nopen;
+#else
+  for (int i = 0; i < g->nevents; i++) {
+    printf("    - %-16s .... %s\n", perf_ev_names[g->event[i]], "Failed");
+  }
+  g->nevents = 0;
+
+  return 0;
+#endif
+}
+
+static inline void perf_close(perf_group_t* g)
+{
+#if defined(__linux__)
+  for (int i = g->nevents - 1; i >= 0; i--) {
+    if (g->fd[i] >= 0) close(g->fd[i]);
+    g->fd[i] = -1;
+  }
+#endif
+  g->nevents = 0;
+}
+
+/* Read the whole group with a single system call */
+static inline void perf_read(perf_group_t* g, uint64_t* values)
+{
+#if defined(__linux__)
+  uint64_t buf[1 + PERF_MAX_COUNTERS];
+
+  if (read(g->fd[0], buf, sizeof(uint64_t) * (1 + g->nevents)) > 0) {
+    for (int i = 0; i < g->nevents; i++) {
+      values[i] = buf[1 + i];
+    }
+  }
+#endif
+}
+
+/* Average a counter over the runs that survived outlier masking */
+static inline double perf_avg(const perf_group_t* g, const uint64_t* counters,
+                              const bool* mask, uint32_t num_runs, int idx)
+{
+  double   sum = 0.0;
+  uint32_t n   = 0;
+
+  for (uint32_t i = 0; i < num_runs; i++) {
+    if (mask == NULL || mask[i]) {
+      sum += counters[i * PERF_MAX_COUNTERS + idx];
+      n   += 1;
+    }
+  }
+
+  return (n > 0) ? (sum / n) : 0.0;
+}
+
+/* Print the counters summary; nelems is the number of elements that *
+ * a single invocation of the implementation processes.              */
+static inline void perf_summary(const perf_group_t* g, const uint64_t* counters,
+                                const bool* mask, uint32_t num_runs,
+                                size_t nelems)
+{
+  if (g->nevents == 0) return;
+
+  int i_cyc = perf_find(g, PERF_EV_CYCLES);
+  int i_ins = perf_find(g, PERF_EV_INSTRUCTIONS);
+
+  printf("  * Performance counters (per invocation):\n");
+  for (int i = 0; i < g->nevents; i++) {
+    double avg = perf_avg(g, counters, mask, num_runs, i);
+    printf("    - %-16s = %.1f (%.4f per element)\n",
+           perf_ev_names[g->event[i]], avg, avg / (double)nelems);
+  }
+
+  if (i_cyc >= 0 && i_ins >= 0) {
+    double cyc = perf_avg(g, counters, mask, num_runs, i_cyc);
+    double ins = perf_avg(g, counters, mask, num_runs, i_ins);
+    printf("    - %-16s = %.3f\n", "IPC", (cyc > 0.0) ? (ins / cyc) : 0.0);
+  }
+}
+
+/* Dump per-run counters and derived metrics to a CSV file */
+static inline void perf_dump(FILE* fp, const perf_group_t* g,
+                             const uint64_t* counters, const bool* mask,
+                             uint32_t num_runs, size_t nelems)
+{
+  if (g->nevents == 0) return;
+
+  int i_cyc = perf_find(g, PERF_EV_CYCLES);
+  int i_ins = perf_find(g, PERF_EV_INSTRUCTIONS);
+
+  for (int i = 0; i < g->nevents; i++) {
+    fprintf(fp, "\n");
+    fprintf(fp, "%s", perf_ev_names[g->event[i]]);
+    for (uint32_t r = 0; r < num_runs; r++) {
+      fprintf(fp, ", ");
+      fprintf(fp, "%" PRIu64 "", counters[r * PERF_MAX_COUNTERS + i]);
+    }
+  }
+
+  for (int i = 0; i < g->nevents; i++) {
+    double avg = perf_avg(g, counters, mask, num_runs, i);
+    fprintf(fp, "\n");
+    fprintf(fp, "%s_per_elem,%f", perf_ev_names[g->event[i]],
+                                  avg / (double)nelems);
+  }
+
+  if (i_cyc >= 0 && i_ins >= 0) {
+    double cyc = perf_avg(g, counters, mask, num_runs, i_cyc);
+    double ins = perf_avg(g, counters, mask, num_runs, i_ins);
+    fprintf(fp, "\n");
+    fprintf(fp, "ipc,%f", (cyc > 0.0) ? (ins / cyc) : 0.0);
+  }
+}
+
+/* Average the counters of one point into per-element columns */
+static inline void perf_point(const perf_group_t* g, const uint64_t* counters,
+                              const bool* mask, uint32_t num_runs,
+                              size_t nelems, perf_point_t* p)
+{
+  int i_cyc = perf_find(g, PERF_EV_CYCLES);
+  int i_ins = perf_find(g, PERF_EV_INSTRUCTIONS);
+
+  for (int i = 0; i < g->nevents; i++) {
+    p->per_elem[i] = perf_avg(g, counters, mask, num_runs, i) / (double)nelems;
+  }
+
+  p->ipc = -1.0;
+  if (i_cyc >= 0 && i_ins >= 0) {
+    double cyc = perf_avg(g, counters, mask, num_runs, i_cyc);
+    double ins = perf_avg(g, counters, mask, num_runs, i_ins);
+    p->ipc = (cyc > 0.0) ? (ins / cyc) : 0.0;
+  }
+}
+
+/* Width of the table column of a counter; 'prefix' tells apart the *
+ * columns of two points on the same row                             */
+static inline int __perf_width(const char* prefix, const char* name,
+                               const char* unit)
+{
+  int w = (int)(strlen(prefix) + strlen(name) + strlen(unit));
+  return (w > 10) ? w : 10;
+}
+
+/* Print the headers of the counter columns of a table */
+static inline void perf_header(const perf_group_t* g, const char* prefix)
+{
+  for (int i = 0; i < g->nevents; i++) {
+    const char* name = perf_ev_names[g->event[i]];
+    char        label[64];
+
+    snprintf(label, sizeof(label), "%s%s/elem", prefix, name);
+    printf(" %*s", __perf_width(prefix, name, "/elem"), label);
+  }
+
+  if (perf_find(g, PERF_EV_CYCLES) >= 0 && perf_find(g, PERF_EV_INSTRUCTIONS) >= 0) {
+    char label[64];
+
+    snprintf(label, sizeof(label), "%sIPC", prefix);
+    printf(" %*s", __perf_width(prefix, "IPC", ""), label);
+  }
+}
+
+/* Print the counter columns of one point */
+static inline void perf_row(const perf_group_t* g, const perf_point_t* p,
+                            const char* prefix)
+{
+  for (int i = 0; i < g->nevents; i++) {
+    printf(" %*.4f", __perf_width(prefix, perf_ev_names[g->event[i]], "/elem"),
+                     p->per_elem[i]);
+  }
+
+  if (p->ipc >= 0.0) {
+    printf(" %*.3f", __perf_width(prefix, "IPC", ""), p->ipc);
+  }
+}
+
+/* Append the counter columns to the header of a CSV table */
+static inline void perf_csv_header(FILE* fp, const perf_group_t* g)
+{
+  for (int i = 0; i < g->nevents; i++) {
+    fprintf(fp, ",%s_per_elem", perf_ev_names[g->event[i]]);
+  }
+
+  if (perf_find(g, PERF_EV_CYCLES) >= 0 && perf_find(g, PERF_EV_INSTRUCTIONS) >= 0) {
+    fprintf(fp, ",ipc");
+  }
+}
+
+/* Append the counter columns of one point to a CSV row */
+static inline void perf_csv_row(FILE* fp, const perf_group_t* g,
+                                const perf_point_t* p)
+{
+  for (int i = 0; i < g->nevents; i++) {
+    fprintf(fp, ",%f", p->per_elem[i]);
+  }
+
+  if (p->ipc >= 0.0) {
+    fprintf(fp, ",%f", p->ipc);
+  }
+}
+
+#endif //__COMMON_PERF_H_
@@ -0,0 +1,299 @@
+/* pool.h
+ *
+ * Author: Khalid Al-Hawaj
+ * Date  : 16 Oct. 2026
+ *
+ * This file contains a persistent, pinned worker pool shared by the
+ * parallel implementations. The pool is started once in main() and is
+ * handed to the implementations through args_t; pool_run() then costs
+ * a generation bump (and a futex wake only if workers went to sleep)
+ * instead of a pthread_create()/pthread_join() pair per thread.
+ *
+ * The caller always acts as worker 0. Idle workers spin for a short
+ * while on the generation word, yielding now and then so that they do
+ * not starve the caller when the CPUs are oversubscribed, and then
+ * sleep on it with futex(). On Darwin, where there is no futex, idle
+ * workers keep yielding instead.
+ *
+ * The generation word packs a dispatch counter with the number of jobs
+ * of that dispatch, so one atomic load tells a worker both that there
+ * is a new dispatch and whether it has a share of it. Only workers 1 ..
+ * njobs - 1 read the job and acknowledge it; the others go back to
+ * waiting without touching it, and a dispatch of one job is not even
+ * published. The job is only rewritten once every worker with a share
+ * has acknowledged it, so those never see it change under them.
+ *
+ * Pinning uses cpu_set_t and pthread_setaffinity_np(), which glibc only
+ * declares under _GNU_SOURCE; includers must define it before their
+ * first system include.
+*/
+
+#ifndef __COMMON_POOL_H_
+#define __COMMON_POOL_H_
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#error "pool.h needs _GNU_SOURCE defined before the first system include"
+#endif
+
+/* Standard C includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <sched.h>
+
+#if defined(__linux__)
+#include <unistd.h>
+#include <limits.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
+
+#if defined(__amd64__) || defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+/* If we are on Darwin, include the compatibility header */
+#if defined(__APPLE__)
+#include "common/mach_pthread_compatibility.h"
+#endif
+
+/* Limits */
+#define POOL_MAX_THREADS 256
+#define POOL_SPIN        (1 << 16)
+
+/* Low bits of the generation word: the jobs of the dispatch */
+#define POOL_NJOBS_BITS  9
+#define POOL_NJOBS_MASK  ((1u << POOL_NJOBS_BITS) - 1)
+
+typedef struct pool pool_t;
+
+typedef struct {
+  pool_t* pool;
+  int     id;
+} __pool_slot_t;
+
+struct pool {
+  int           nworkers;
+  pthread_t     tid [POOL_MAX_THREADS];
+  int           cpus[POOL_MAX_THREADS];
+  __pool_slot_t slot[POOL_MAX_THREADS];
+
+  /* Current job; worker i runs fn(args[i]) if i < njobs */
+  void*       (*fn)(void* args);
+  void*         args[POOL_MAX_THREADS];
+
+  /* Synchronization */
+  uint32_t      generation;  /* dispatch counter and njobs (futex word) */
+  uint32_t      sleepers;    /* workers sleeping on generation          */
+  uint32_t      pending;     /* workers yet to acknowledge the job      */
+  uint32_t      waiting;     /* caller sleeping on pending            */
+  uint32_t      stop;
+};
+
+static inline void __pool_pause(uint32_t spins)
+{
+#if defined(__amd64__) || defined(__x86_64__)
+  _mm_pause();
+#endif
+  if ((spins & 0xff) == 0xff) sched_yield();
+}
+
+static inline void __pool_futex_wait(uint32_t* addr, uint32_t val)
+{
+#if defined(__linux__)
+  syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0);
+#else
+  (void)addr; (void)val;
+  sched_yield();
+#endif
+}
+
+static inline void __pool_futex_wake(uint32_t* addr)
+{
+#if defined(__linux__)
+  syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+#else
+  (void)addr;
+#endif
+}
+
+static inline void __pool_pin(pthread_t tid, int cpu)
+{
+  cpu_set_t cpuset;
+
+  CPU_ZERO(&cpuset);
+  CPU_SET(cpu, &cpuset);
+
+  int __attribute__((unused)) res = pthread_setaffinity_np(tid,
+                                           sizeof(cpuset), &cpuset);
+}
+
+static void* __pool_worker(void* arg)
+{
+  pool_t*  p    = ((__pool_slot_t*)arg)->pool;
+  int      id   = ((__pool_slot_t*)arg)->id;
+  uint32_t seen = 0;
+
+  while (true) {
+    /* Wait for the next dispatch: spin first, then sleep */
+    uint32_t gen;
+    uint32_t spins = 0;
+    while ((gen = __atomic_load_n(&p->generation, __ATOMIC_ACQUIRE)) == seen) {
+      if (++spins < POOL_SPIN) {
+        __pool_pause(spins);
+        continue;
+      }
+
+      __atomic_add_fetch(&p->sleepers, 1, __ATOMIC_SEQ_CST);
+      if (__atomic_load_n(&p->generation, __ATOMIC_SEQ_CST) == seen) {
+        __pool_futex_wait(&p->generation, seen);
+      }
+      __atomic_sub_fetch(&p->sleepers, 1, __ATOMIC_SEQ_CST);
+    }
+    seen = gen;
+
+    if (__atomic_load_n(&p->stop, __ATOMIC_ACQUIRE)) break;
+
+    /* Without a share, there is nothing to read or acknowledge */
+    if (id >= (int)(gen & POOL_NJOBS_MASK)) continue;
+
+    /* Run our share; then acknowledge it, and wake the caller if we *
+     * are the last one                                               */
+    p->fn(p->args[id]);
+
+    if (__atomic_sub_fetch(&p->pending, 1, __ATOMIC_SEQ_CST) == 0 &&
+        __atomic_load_n(&p->waiting, __ATOMIC_SEQ_CST)) {
+      __pool_futex_wake(&p->pending);
+    }
+  }
+
+  return NULL;
+}
+
+/* Start nworkers - 1 pinned threads; the caller is pinned to cpus[0] *
+ * and acts as worker 0. Returns false if the pool is too large or a  *
+ * thread cannot be created; pool_stop() must still be called.        */
+static inline bool pool_start(pool_t* p, int nworkers, const int* cpus)
+{
+  p->nworkers   = 1;
+  p->stop       = 0;
+
+  if (nworkers < 1               ) nworkers = 1;
+  if (nworkers > POOL_MAX_THREADS) return false;
+
+  p->nworkers   = nworkers;
+  p->fn         = NULL;
+  p->generation = 0;
+  p->sleepers   = 0;
+  p->pending    = 0;
+  p->waiting    = 0;
+
+  for (int i = 0; i < nworkers; i++) {
+    p->cpus[i]    = cpus[i];
+    p->slot[i]    = (__pool_slot_t){ .pool = p, .id = i };
+  }
+
+  p->tid[0] = pthread_self();
+  __pool_pin(p->tid[0], p->cpus[0]);
+
+  for (int i = 1; i < nworkers; i++) {
+    if (pthread_create(&p->tid[i], NULL, __pool_worker, &p->slot[i]) != 0) {
+      p->nworkers = i;
+      return false;
+    }
+    __pool_pin(p->tid[i], p->cpus[i]);
+  }
+
+  return true;
+}
+
+/* Next value of the generation word, for a dispatch of njobs */
+static inline uint32_t __pool_next(const pool_t* p, int njobs)
+{
+  uint32_t gen = __atomic_load_n(&p->generation, __ATOMIC_RELAXED);
+
+  return (((gen >> POOL_NJOBS_BITS) + 1) << POOL_NJOBS_BITS) | (uint32_t)njobs;
+}
+
+/* Run fn(args[i]) on workers 0 .. njobs - 1 and wait for them; worker *
+ * 0 is the caller. njobs must not exceed the pool size.               */
+static inline void pool_run(pool_t* p, void* (*fn)(void* args),
+                            void** args, int njobs)
+{
+  if (njobs > p->nworkers) njobs = p->nworkers;
+  if (njobs < 1) return;
+
+  /* The caller alone */
+  if (njobs == 1) {
+    fn(args[0]);
+    return;
+  }
+
+  p->fn = fn;
+  for (int i = 0; i < njobs; i++) {
+    p->args[i] = args[i];
+  }
+  __atomic_store_n(&p->pending, njobs - 1, __ATOMIC_SEQ_CST);
+
+  /* Publish the job */
+  __atomic_store_n(&p->generation, __pool_next(p, njobs), __ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&p->sleepers, __ATOMIC_SEQ_CST) > 0) {
+    __pool_futex_wake(&p->generation);
+  }
+
+  /* Our own share */
+  fn(args[0]);
+
+  /* Wait for the others: spin first, then sleep */
+  uint32_t spins = 0;
+  uint32_t left;
+  while ((left = __atomic_load_n(&p->pending, __ATOMIC_SEQ_CST)) > 0) {
+    if (++spins < POOL_SPIN) {
+      __pool_pause(spins);
+      continue;
+    }
+
+    __atomic_store_n(&p->waiting, 1, __ATOMIC_SEQ_CST);
+    if ((left = __atomic_load_n(&p->pending, __ATOMIC_SEQ_CST)) > 0) {
+      __pool_futex_wait(&p->pending, left);
+    }
+    __atomic_store_n(&p->waiting, 0, __ATOMIC_SEQ_CST);
+  }
+}
+
+/* Stop and join all workers */
+static inline void pool_stop(pool_t* p)
+{
+  __atomic_store_n(&p->stop, 1, __ATOMIC_SEQ_CST);
+  __atomic_store_n(&p->generation, __pool_next(p, 0), __ATOMIC_SEQ_CST);
+  __pool_futex_wake(&p->generation);
+
+  for (int i = 1; i < p->nworkers; i++) {
+    pthread_join(p->tid[i], NULL);
+  }
+  p->nworkers = 1;
+}
+
+/* Run a job on a pool if there is one, or else on a temporary pool *
+ * pinned to cpus (e.g. with --spawn); returns false if the latter   *
+ * cannot be started.                                                */
+static inline bool pool_run_once(pool_t* p, const int* cpus,
+                                 void* (*fn)(void* args), void** args,
+                                 int njobs)
+{
+  if (p != NULL) {
+    pool_run(p, fn, args, njobs);
+    return true;
+  }
+
+  pool_t tmp;
+  bool   ok = pool_start(&tmp, njobs, cpus);
+  if (ok) pool_run(&tmp, fn, args, njobs);
+  pool_stop(&tmp);
+
+  return ok;
+}
+
+#endif //__COMMON_POOL_H_
@@ -0,0 +1,241 @@
+/* rng.h
+ *
+ * Author: Khalid Al-Hawaj
+ * Date  : 16 Oct. 2026
+ *
+ * This file contains the counter-based generator used for the datasets.
+ * It is Philox4x32-10 (Salmon et al., SC'11): the 16 bytes at offset 16*b
+ * of a stream are philox(counter = {b, 0, 0, 0}, key = {seed, stream}).
+ * Any byte can be computed without generating the ones before it, so a
+ * buffer can be filled by any number of workers, in any order, and the
+ * contents only depend on the seed and the stream.
+ *
+ * With AVX2, eight counters are processed at a time; the 32x32->64-bit
+ * products come from _mm256_mul_epu32 on the even and the odd lanes.
+ *
+ * Real datasets (rng_fill_parallel_real) turn the bits of each float or
+ * double into a uniform value in [-1, 1), so they hold no NaN or Inf.
+*/
+
+#ifndef __COMMON_RNG_H_
+#define __COMMON_RNG_H_
+
+/* Standard C includes */
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/* Include common headers */
+#include "common/types.h"
+#include "common/pool.h"
+
+/* Default seed */
+#define RNG_SEED 0xdeadbeef
+
+/* Philox4x32 constants */
+#define __PHILOX_M0 0xD2511F53u
+#define __PHILOX_M1 0xCD9E8D57u
+#define __PHILOX_W0 0x9E3779B9u
+#define __PHILOX_W1 0xBB67AE85u
+
+/* One block of 16 bytes */
+static inline void rng_block(uint64_t b, uint32_t seed, uint32_t stream,
+                             uint32_t out[4])
+{
+  uint32_t c0 = (uint32_t)b, c1 = (uint32_t)(b >> 32), c2 = 0, c3 = 0;
+  uint32_t k0 = seed, k1 = stream;
+
+  for (int r = 0; r < 10; r++) {
+    uint64_t p0 = (uint64_t)__PHILOX_M0 * c0;
+    uint64_t p1 = (uint64_t)__PHILOX_M1 * c2;
+
+    uint32_t n0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+    uint32_t n2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+    c1 = (uint32_t)p1;
+    c3 = (uint32_t)p0;
+    c0 = n0;
+    c2 = n2;
+
+    k0 += __PHILOX_W0;
+    k1 += __PHILOX_W1;
+  }
+
+  out[0] = c0; out[1] = c1; out[2] = c2; out[3] = c3;
+}
+
+#if defined(__AVX2__)
+/* Eight blocks b .. b + 7 (128 bytes) */
+static inline void __rng_block8(uint64_t b, uint32_t seed, uint32_t stream,
+                                byte* dst)
+{
+  const __m256i m0 = _mm256_set1_epi32(__PHILOX_M0);
+  const __m256i m1 = _mm256_set1_epi32(__PHILOX_M1);
+
+  __m256i c0 = _mm256_add_epi32(_mm256_set1_epi32((uint32_t)b),
+                                _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+  __m256i c1 = _mm256_set1_epi32((uint32_t)(b >> 32));
+  __m256i c2 = _mm256_setzero_si256();
+  __m256i c3 = _mm256_setzero_si256();
+
+  /* The low word must not wrap within the eight blocks */
+  if ((uint32_t)b > 0xfffffff8u) {
+    for (int i = 0; i < 8; i++) rng_block(b + i, seed, stream,
+                                          (uint32_t*)(dst + 16 * i));
+    return;
+  }
+
+  uint32_t k0 = seed, k1 = stream;
+  for (int r = 0; r < 10; r++) {
+    __m256i pe0 = _mm256_mul_epu32(c0, m0);
+    __m256i po0 = _mm256_mul_epu32(_mm256_srli_epi64(c0, 32), m0);
+    __m256i pe1 = _mm256_mul_epu32(c2, m1);
+    __m256i po1 = _mm256_mul_epu32(_mm256_srli_epi64(c2, 32), m1);
+
+    __m256i lo0 = _mm256_blend_epi32(pe0, _mm256_slli_epi64(po0, 32), 0xaa);
+    __m256i hi0 = _mm256_blend_epi32(_mm256_srli_epi64(pe0, 32), po0, 0xaa);
+    __m256i lo1 = _mm256_blend_epi32(pe1, _mm256_slli_epi64(po1, 32), 0xaa);
+    __m256i hi1 = _mm256_blend_epi32(_mm256_srli_epi64(pe1, 32), po1, 0xaa);
+
+    c0 = _mm256_xor_si256(_mm256_xor_si256(hi1, c1), _mm256_set1_epi32(k0));
+    c2 = _mm256_xor_si256(_mm256_xor_si256(hi0, c3), _mm256_set1_epi32(k1));
+    c1 = lo1;
+    c3 = lo0;
+
+    k0 += __PHILOX_W0;
+    k1 += __PHILOX_W1;
+  }
+
+  /* Transpose to block-major order */
+  __m256i t0 = _mm256_unpacklo_epi32(c0, c1);  /* b0 b1 | b4 b5 (words 0,1) */
+  __m256i t1 = _mm256_unpacklo_epi32(c2, c3);  /* b0 b1 | b4 b5 (words 2,3) */
+  __m256i t2 = _mm256_unpackhi_epi32(c0, c1);  /* b2 b3 | b6 b7 (words 0,1) */
+  __m256i t3 = _mm256_unpackhi_epi32(c2, c3);  /* b2 b3 | b6 b7 (words 2,3) */
+
+  __m256i b04 = _mm256_unpacklo_epi64(t0, t1);
+  __m256i b15 = _mm256_unpackhi_epi64(t0, t1);
+  __m256i b26 = _mm256_unpacklo_epi64(t2, t3);
+  __m256i b37 = _mm256_unpackhi_epi64(t2, t3);
+
+  _mm256_storeu_si256((__m256i*)(dst +  0), _mm256_permute2x128_si256(b04, b15, 0x20));
+  _mm256_storeu_si256((__m256i*)(dst + 32), _mm256_permute2x128_si256(b26, b37, 0x20));
+  _mm256_storeu_si256((__m256i*)(dst + 64), _mm256_permute2x128_si256(b04, b15, 0x31));
+  _mm256_storeu_si256((__m256i*)(dst + 96), _mm256_permute2x128_si256(b26, b37, 0x31));
+}
+#endif
+
+/* Write bytes [lo, hi) of a stream to buf + lo */
+static inline void rng_fill(void* buf, size_t lo, size_t hi,
+                            uint32_t seed, uint32_t stream)
+{
+  byte*    dst = (byte*)buf;
+  uint32_t blk[4];
+
+  /* Leading partial block */
+  if (lo < hi && (lo % 16) != 0) {
+    rng_block(lo / 16, seed, stream, blk);
+    size_t end = (lo / 16) * 16 + 16;
+    if (end > hi) end = hi;
+    memcpy(dst + lo, (byte*)blk + (lo % 16), end - lo);
+    lo = end;
+  }
+
+  /* Whole blocks */
+#if defined(__AVX2__)
+  for (; lo + 128 <= hi; lo += 128) {
+    __rng_block8(lo / 16, seed, stream, dst + lo);
+  }
+#endif
+  for (; lo + 16 <= hi; lo += 16) {
+    rng_block(lo / 16, seed, stream, blk);
+    memcpy(dst + lo, blk, 16);
+  }
+
+  /* Trailing partial block */
+  if (lo < hi) {
+    rng_block(lo / 16, seed, stream, blk);
+    memcpy(dst + lo, blk, hi - lo);
+  }
+}
+
+/* Parallel fill */
+typedef struct {
+  void*    buf;
+  size_t   lo;
+  size_t   hi;
+  uint32_t seed;
+  uint32_t stream;
+  size_t   real;    /* 0, or the size of the float type to convert to */
+} __rng_range_t;
+
+/* Uniform values in [-1, 1) from the bits of [lo, hi) */
+static inline void __rng_to_real(void* buf, size_t lo, size_t hi, size_t real)
+{
+  if (real == sizeof(float)) {
+    int32_t* p = (int32_t*)((byte*)buf + lo);
+    for (size_t i = 0; i < (hi - lo) / sizeof(float); i++) {
+      float f = (float)(p[i] >> 8) * 0x1p-23f;
+      memcpy(&p[i], &f, sizeof(f));
+    }
+  } else if (real == sizeof(double)) {
+    int64_t* p = (int64_t*)((byte*)buf + lo);
+    for (size_t i = 0; i < (hi - lo) / sizeof(double); i++) {
+      double d = (double)(p[i] >> 11) * 0x1p-52;
+      memcpy(&p[i], &d, sizeof(d));
+    }
+  }
+}
+
+static void* __rng_fill_range(void* arg)
+{
+  __rng_range_t* r = (__rng_range_t*)arg;
+  rng_fill(r->buf, r->lo, r->hi, r->seed, r->stream);
+  if (r->real > 0) __rng_to_real(r->buf, r->lo, r->hi, r->real);
+
+  return NULL;
+}
+
+static inline void __rng_fill_parallel(pool_t* pool, const int* cpus,
+                                       int nworkers, void* buf, size_t nbytes,
+                                       uint32_t seed, uint32_t stream,
+                                       size_t real)
+{
+  __rng_range_t ranges[nworkers];
+  void*         targs [nworkers];
+
+  size_t per = ((nbytes / nworkers) + 63) & ~(size_t)63;
+  for (int w = 0; w < nworkers; w++) {
+    size_t lo = (size_t)w * per;
+    size_t hi = (w == nworkers - 1) ? nbytes : lo + per;
+    if (lo > nbytes) lo = nbytes;
+    if (hi > nbytes) hi = nbytes;
+
+    ranges[w] = (__rng_range_t){ buf, lo, hi, seed, stream, real };
+    targs[w]  = &ranges[w];
+  }
+
+  pool_run_once(pool, cpus, __rng_fill_range, targs, nworkers);
+}
+
+/* Fill nbytes of a stream using nworkers workers (cache-line aligned *
+ * ranges); the result does not depend on nworkers.                   */
+static inline void rng_fill_parallel(pool_t* pool, const int* cpus,
+                                     int nworkers, void* buf, size_t nbytes,
+                                     uint32_t seed, uint32_t stream)
+{
+  __rng_fill_parallel(pool, cpus, nworkers, buf, nbytes, seed, stream, 0);
+}
+
+/* Same, as floats (real = 4) or doubles (real = 8) in [-1, 1) */
+static inline void rng_fill_parallel_real(pool_t* pool, const int* cpus,
+                                          int nworkers, void* buf,
+                                          size_t nbytes, size_t real,
+                                          uint32_t seed, uint32_t stream)
+{
+  __rng_fill_parallel(pool, cpus, nworkers, buf, nbytes, seed, stream, real);
+}
+
+#endif //__COMMON_RNG_H_
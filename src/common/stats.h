@@ -0,0 +1,351 @@
+/* stats.h
+ *
+ * Author: Khalid Al-Hawaj
+ * Date  : 16 Oct. 2026
+ *
+ * This file contains the statistics engine shared by all benchmarks.
+ * Given the per-run runtimes (ns per invocation, as doubles, so that the
+ * sub-ns resolution of averaging many invocations is kept) it computes:
+ *
+ *   - min, max, median, p90, p99 and p99.9 (linear interpolation)
+ *   - the median absolute deviation (MAD)
+ *   - a bootstrap 95% confidence interval for the median
+ *   - the outlier-free mean and standard deviation, where runs that
+ *     are more than nstd standard deviations away from the mean are
+ *     masked off iteratively until no more runs are masked
+ *
+ * For interleaved A/B runs it also provides paired comparisons: the
+ * mean and median paired difference, a paired t-test and a Wilcoxon
+ * signed-rank test (both two-sided, normal approximation).
+ *
+ * All arithmetic is done in double precision, so no deviation can
+ * wrap around. The bootstrap uses its own fixed-seed generator; it is
+ * deterministic and does not disturb the rand() stream.
+*/
+
+#ifndef __COMMON_STATS_H_
+#define __COMMON_STATS_H_
+
+/* Standard C includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <math.h>
+
+/* Number of bootstrap resamples */
+#define STATS_NUM_BOOTSTRAP 1000
+
+typedef struct {
+  uint32_t n;
+
+  /* Order statistics */
+  double   min;
+  double   max;
+  double   median;
+  double   p90;
+  double   p99;
+  double   p999;
+  double   mad;
+
+  /* Bootstrap 95% confidence interval of the median */
+  double   ci_lo;
+  double   ci_hi;
+
+  /* Outlier-free mean */
+  double   mean;
+  double   std;
+  uint32_t n_active;
+  uint32_t n_passes;
+} stats_t;
+
+static inline int __stats_cmp(const void* a, const void* b)
+{
+  double x = *(const double*)a;
+  double y = *(const double*)b;
+  return (x > y) - (x < y);
+}
+
+static inline int __stats_abs_cmp(const void* a, const void* b)
+{
+  double x = fabs(*(const double*)a);
+  double y = fabs(*(const double*)b);
+  return (x > y) - (x < y);
+}
+
+/* Percentile of a sorted array, p in [0, 1] */
+static inline double stats_percentile(const double* sorted, uint32_t n,
+                                      double p)
+{
+  if (n == 0) return 0.0;
+
+  double   pos = p * (n - 1);
+  uint32_t lo  = (uint32_t)floor(pos);
+  uint32_t hi  = (lo + 1 < n) ? (lo + 1) : lo;
+  double   w   = pos - lo;
+
+  return sorted[lo] * (1.0 - w) + sorted[hi] * w;
+}
+
+/* xorshift64* for the bootstrap */
+static inline uint64_t __stats_rand(uint64_t* state)
+{
+  uint64_t x = *state;
+  x ^= x >> 12;
+  x ^= x << 25;
+  x ^= x >> 27;
+  *state = x;
+  return x * 0x2545F4914F6CDD1Dllu;
+}
+
+/* Bootstrap the median of a sorted array. Because the array is     *
+ * sorted, the median of a resample is the element at the median of *
+ * the resampled indices, which a histogram finds in O(n).           */
+static inline void stats_bootstrap_median(const double* sorted, uint32_t n,
+                                          uint32_t nboot,
+                                          double* lo, double* hi)
+{
+  if (n < 2) {
+    *lo = *hi = (n == 1) ? sorted[0] : 0.0;
+    return;
+  }
+
+  uint32_t* hist    = (uint32_t*)malloc(n * sizeof(uint32_t));
+  double*   medians = (double*  )malloc(nboot * sizeof(double));
+  uint64_t  state   = 0x9e3779b97f4a7c15llu;
+
+  for (uint32_t b = 0; b < nboot; b++) {
+    memset(hist, 0, n * sizeof(uint32_t));
+    for (uint32_t i = 0; i < n; i++) {
+      hist[__stats_rand(&state) % n]++;
+    }
+
+    /* Walk to the middle rank(s) */
+    uint32_t r_lo = (n - 1) / 2;
+    uint32_t r_hi = n / 2;
+    uint32_t cum  = 0;
+    int64_t  i_lo = -1;
+    int64_t  i_hi = -1;
+    for (uint32_t i = 0; i < n && i_hi < 0; i++) {
+      cum += hist[i];
+      if (i_lo < 0 && cum > r_lo) i_lo = i;
+      if (i_hi < 0 && cum > r_hi) i_hi = i;
+    }
+
+    medians[b] = (sorted[i_lo] + sorted[i_hi]) / 2.0;
+  }
+
+  qsort(medians, nboot, sizeof(double), __stats_cmp);
+  *lo = stats_percentile(medians, nboot, 0.025);
+  *hi = stats_percentile(medians, nboot, 0.975);
+
+  free(hist);
+  free(medians);
+}
+
+/* Compute all statistics; mask is updated to flag the runs that are *
+ * kept by the outlier-free mean.                                    */
+static inline void stats_compute(stats_t* s, const double* samples,
+                                 bool* mask, uint32_t n, unsigned int nstd)
+{
+  memset(s, 0, sizeof(*s));
+  s->n = n;
+  if (n == 0) return;
+
+  /*   -> Order statistics */
+  double* sorted = (double*)malloc(n * sizeof(double));
+  for (uint32_t i = 0; i < n; i++) {
+    sorted[i] = samples[i];
+  }
+  qsort(sorted, n, sizeof(double), __stats_cmp);
+
+  s->min    = sorted[0];
+  s->max    = sorted[n - 1];
+  s->median = stats_percentile(sorted, n, 0.500);
+  s->p90    = stats_percentile(sorted, n, 0.900);
+  s->p99    = stats_percentile(sorted, n, 0.990);
+  s->p999   = stats_percentile(sorted, n, 0.999);
+
+  /*   -> Median absolute deviation */
+  double* dev = (double*)malloc(n * sizeof(double));
+  for (uint32_t i = 0; i < n; i++) {
+    dev[i] = fabs(sorted[i] - s->median);
+  }
+  qsort(dev, n, sizeof(double), __stats_cmp);
+  s->mad = stats_percentile(dev, n, 0.5);
+  free(dev);
+
+  /*   -> Confidence interval of the median */
+  stats_bootstrap_median(sorted, n, STATS_NUM_BOOTSTRAP, &s->ci_lo, &s->ci_hi);
+  free(sorted);
+
+  /*   -> Outlier-free mean */
+  for (uint32_t i = 0; i < n; i++) {
+    mask[i] = true;
+  }
+
+  uint32_t n_msked;
+  do {
+    s->n_passes++;
+
+    double   sum = 0.0;
+    uint32_t cnt = 0;
+    for (uint32_t i = 0; i < n; i++) {
+      if (mask[i]) { sum += samples[i]; cnt++; }
+    }
+    s->mean     = sum / cnt;
+    s->n_active = cnt;
+
+    double var = 0.0;
+    for (uint32_t i = 0; i < n; i++) {
+      if (mask[i]) {
+        double d = samples[i] - s->mean;
+        var += d * d;
+      }
+    }
+    s->std = sqrt(var / cnt);
+
+    n_msked = 0;
+    for (uint32_t i = 0; i < n; i++) {
+      if (mask[i] && fabs(samples[i] - s->mean) > nstd * s->std) {
+        mask[i]  = false;
+        n_msked += 1;
+      }
+    }
+  } while (n_msked > 0 && n_msked < s->n_active);
+}
+
+/* Shuffle 'order' in place (Fisher-Yates) */
+static inline void stats_shuffle(int* order, int n, uint64_t* state)
+{
+  for (int i = n - 1; i > 0; i--) {
+    int j = (int)(__stats_rand(state) % (uint64_t)(i + 1));
+    int t = order[i]; order[i] = order[j]; order[j] = t;
+  }
+}
+
+/* Paired comparison of two sets of runs taken in the same rounds */
+typedef struct {
+  uint32_t n;
+
+  double   mean_diff;    /* mean of (b - a), in ns        */
+  double   median_diff;  /* median of (b - a), in ns      */
+  double   median_ratio; /* median of (b / a)             */
+
+  double   t;            /* paired t statistic            */
+  double   p_t;          /* two-sided, normal approx.     */
+  double   z_w;          /* Wilcoxon signed-rank z score  */
+  double   p_w;          /* two-sided, normal approx.     */
+} stats_paired_t;
+
+static inline void stats_paired(stats_paired_t* p, const double* a,
+                                const double* b, uint32_t n)
+{
+  memset(p, 0, sizeof(*p));
+  p->n = n;
+  if (n < 2) return;
+
+  double* d = (double*)malloc(n * sizeof(double));
+  double* r = (double*)malloc(n * sizeof(double));
+
+  /*   -> Paired t-test */
+  double sum = 0.0;
+  for (uint32_t i = 0; i < n; i++) {
+    d[i] = b[i] - a[i];
+    r[i] = (a[i] > 0.0) ? (b[i] / a[i]) : 1.0;
+    sum += d[i];
+  }
+  p->mean_diff = sum / n;
+
+  double var = 0.0;
+  for (uint32_t i = 0; i < n; i++) {
+    var += (d[i] - p->mean_diff) * (d[i] - p->mean_diff);
+  }
+  double se = sqrt(var / (n - 1) / n);
+  p->t   = (se > 0.0) ? (p->mean_diff / se) : 0.0;
+  p->p_t = (se > 0.0) ? erfc(fabs(p->t) / sqrt(2.0)) : 1.0;
+
+  qsort(r, n, sizeof(double), __stats_cmp);
+  p->median_ratio = stats_percentile(r, n, 0.5);
+
+  /*   -> Median difference */
+  for (uint32_t i = 0; i < n; i++) {
+    r[i] = d[i];
+  }
+  qsort(r, n, sizeof(double), __stats_cmp);
+  p->median_diff = stats_percentile(r, n, 0.5);
+
+  /*   -> Wilcoxon signed-rank test; zero differences are dropped */
+  uint32_t m = 0;
+  for (uint32_t i = 0; i < n; i++) {
+    if (d[i] != 0.0) d[m++] = d[i];
+  }
+  qsort(d, m, sizeof(double), __stats_abs_cmp);
+
+  double w_pos = 0.0;
+  double ties  = 0.0;
+  for (uint32_t i = 0; i < m; ) {
+    uint32_t j = i;
+    while (j + 1 < m && fabs(d[j + 1]) == fabs(d[i])) j++;
+
+    double rank = (i + j + 2) / 2.0;  /* average rank of the tie */
+    double t    = (double)(j - i + 1);
+    ties += t * t * t - t;
+
+    for (uint32_t k = i; k <= j; k++) {
+      if (d[k] > 0.0) w_pos += rank;
+    }
+    i = j + 1;
+  }
+
+  double mu    = m * (m + 1.0) / 4.0;
+  double sigma = sqrt(m * (m + 1.0) * (2.0 * m + 1.0) / 24.0 - ties / 48.0);
+  p->z_w = (sigma > 0.0) ? ((w_pos - mu) / sigma) : 0.0;
+  p->p_w = (sigma > 0.0) ? erfc(fabs(p->z_w) / sqrt(2.0)) : 1.0;
+
+  free(d);
+  free(r);
+}
+
+static inline void stats_print(const stats_t* s)
+{
+  printf("    + Min / Max          = %.1f / %.1f ns\n", s->min, s->max);
+  printf("    + Median             = %.1f ns (95%% CI [%.1f, %.1f])\n",
+                                      s->median, s->ci_lo, s->ci_hi);
+  printf("    + p90 / p99 / p99.9  = %.1f / %.1f / %.1f ns\n",
+                                      s->p90, s->p99, s->p999);
+  printf("    + MAD                = %.1f ns\n", s->mad);
+  printf("    + Outlier-free mean  = %.1f ns (std = %.1f ns)\n",
+                                      s->mean, s->std);
+  printf("    + Active runs        = %u of %u (%u passes)\n",
+                                      s->n_active, s->n, s->n_passes);
+}
+
+static inline void stats_dump(FILE* fp, const stats_t* s)
+{
+  fprintf(fp, "\n");
+  fprintf(fp, "avg,%f", s->mean);
+  fprintf(fp, "\n");
+  fprintf(fp, "std,%f", s->std);
+  fprintf(fp, "\n");
+  fprintf(fp, "min,%f", s->min);
+  fprintf(fp, "\n");
+  fprintf(fp, "max,%f", s->max);
+  fprintf(fp, "\n");
+  fprintf(fp, "median,%f", s->median);
+  fprintf(fp, "\n");
+  fprintf(fp, "median_ci95_lo,%f", s->ci_lo);
+  fprintf(fp, "\n");
+  fprintf(fp, "median_ci95_hi,%f", s->ci_hi);
+  fprintf(fp, "\n");
+  fprintf(fp, "p90,%f", s->p90);
+  fprintf(fp, "\n");
+  fprintf(fp, "p99,%f", s->p99);
+  fprintf(fp, "\n");
+  fprintf(fp, "p999,%f", s->p999);
+  fprintf(fp, "\n");
+  fprintf(fp, "mad,%f", s->mad);
+}
+
+#endif //__COMMON_STATS_H_
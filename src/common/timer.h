@@ -0,0 +1,173 @@
+/* timer.h
+ *
+ * Author: Khalid Al-Hawaj
+ * Date  : 16 Oct. 2026
+ *
+ * This file contains the timer backends used by the timing macros.
+ * Two sources are available:
+ *
+ *   clock: clock_gettime() with the clk_id set to CLOCK_MONOTONIC
+ *   tsc  : the time-stamp counter; the start stamp is serialized
+ *          with lfence/rdtsc/lfence and the end stamp with
+ *          rdtscp/lfence, so the measured window cannot leak into
+ *          the surrounding code in either direction.
+ *
+ * At startup the TSC frequency is calibrated against CLOCK_MONOTONIC,
+ * and the overhead of a back-to-back start/end pair is measured for
+ * the selected source. That overhead is subtracted from every sample.
+*/
+
+#ifndef __COMMON_TIMER_H_
+#define __COMMON_TIMER_H_
+
+/* Standard C includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <time.h>
+
+#if defined(__amd64__) || defined(__x86_64__)
+#include <x86intrin.h>
+#include <cpuid.h>
+#endif
+
+/* Timer sources */
+typedef enum {
+  TIMER_CLOCK = 0,
+  TIMER_TSC
+} timer_src_t;
+
+#define __timer_name(x) ((x) == TIMER_TSC ? "tsc" : "clock")
+
+/* Timer configuration */
+typedef struct {
+  timer_src_t src;
+
+  double      ns_per_tick;
+  uint64_t    overhead;      /* in ticks */
+  bool        invariant;     /* TSC only */
+} timer_cfg_t;
+
+static inline void timer_init(timer_cfg_t* t)
+{
+  t->src         = TIMER_CLOCK;
+  t->ns_per_tick = 1.0;
+  t->overhead    = 0;
+  t->invariant   = true;
+}
+
+static inline bool timer_parse(timer_cfg_t* t, const char* str)
+{
+  if (strcasecmp(str, "clock") == 0) { t->src = TIMER_CLOCK; return true; }
+  if (strcasecmp(str, "tsc"  ) == 0) { t->src = TIMER_TSC  ; return true; }
+
+  return false;
+}
+
+/* Raw stamps */
+static inline uint64_t timer_clock_ns(void)
+{
+  struct timespec ts;
+
+  if (clock_gettime(CLOCK_MONOTONIC, &ts) == -1) {
+    printf("\n\n    ERROR: getting time failed!\n\n");
+    exit(-1);
+  }
+
+  return ((uint64_t)ts.tv_sec * 1000000000llu) + (uint64_t)ts.tv_nsec;
+}
+
+static inline uint64_t timer_start(const timer_cfg_t* t)
+{
+#if defined(__amd64__) || defined(__x86_64__)
+  if (t->src == TIMER_TSC) {
+    _mm_lfence();
+    uint64_t tsc = __rdtsc();
+    _mm_lfence();
+    return tsc;
+  }
+#endif
+  return timer_clock_ns();
+}
+
+static inline uint64_t timer_stop(const timer_cfg_t* t)
+{
+#if defined(__amd64__) || defined(__x86_64__)
+  if (t->src == TIMER_TSC) {
+    unsigned int aux;
+    uint64_t tsc = __rdtscp(&aux);
+    _mm_lfence();
+    return tsc;
+  }
+#endif
+  return timer_clock_ns();
+}
+
+/* Elapsed time in nanoseconds, with the timer overhead removed */
+static inline double timer_elapsed_ns(const timer_cfg_t* t,
+                                      uint64_t ts, uint64_t te)
+{
+  uint64_t ticks = te - ts;
+  ticks = (ticks > t->overhead) ? (ticks - t->overhead) : 0;
+
+  return (double)ticks * t->ns_per_tick;
+}
+
+/* Calibrate the TSC frequency and measure the overhead of the timer; *
+ * falls back to the clock source if the TSC is not available.        */
+static inline void timer_calibrate(timer_cfg_t* t)
+{
+  if (t->src == TIMER_TSC) {
+#if defined(__amd64__) || defined(__x86_64__)
+    /* Invariant TSC: CPUID.80000007H:EDX[8] */
+    unsigned int eax, ebx, ecx, edx;
+    t->invariant = false;
+    if (__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) {
+      t->invariant = (edx >> 8) & 0x1;
+    }
+
+    /* Take the median of a few 20 ms windows */
+    double est[5];
+    for (int r = 0; r < 5; r++) {
+      uint64_t c0 = timer_clock_ns();
+      uint64_t t0 = timer_start(t);
+      uint64_t c1, t1;
+      do {
+        c1 = timer_clock_ns();
+        t1 = timer_stop(t);
+      } while ((c1 - c0) < 20000000llu);
+
+      est[r] = (double)(c1 - c0) / (double)(t1 - t0);
+    }
+
+    for (int i = 1; i < 5; i++) {
+      for (int j = i; j > 0 && est[j - 1] > est[j]; j--) {
+        double tmp = est[j]; est[j] = est[j - 1]; est[j - 1] = tmp;
+      }
+    }
+    t->ns_per_tick = est[2];
+#else
+    t->src = TIMER_CLOCK;
+#endif
+  }
+
+  if (t->src == TIMER_CLOCK) {
+    t->ns_per_tick = 1.0;
+  }
+
+  /* Overhead is the minimum of many empty start/end pairs */
+  uint64_t overhead = -1;
+  for (int r = 0; r < 10000; r++) {
+    uint64_t ts = timer_start(t);
+    __asm__ __volatile__ ("" : : : "memory");
+    uint64_t te = timer_stop(t);
+
+    if ((te - ts) < overhead) overhead = te - ts;
+  }
+  t->overhead = overhead;
+}
+
+#endif //__COMMON_TIMER_H_
@@ -0,0 +1,392 @@
+/* topo.h
+ *
+ * Author: Khalid Al-Hawaj
+ * Date  : 16 Oct. 2026
+ *
+ * This file contains the CPU topology and the thread placement policies.
+ * The topology is read from /sys/devices/system/cpu (SMT siblings, cores,
+ * packages and the sharing of the last-level cache) and from
+ * /sys/devices/system/node (NUMA nodes), restricted to the CPUs that the
+ * process is allowed to run on. Four placements are available:
+ *
+ *   compact    : fill a core (all SMT siblings) before moving to the next
+ *                core, and a package before moving to the next package
+ *   scatter    : one thread per core, alternating between packages, and
+ *                only then the SMT siblings
+ *   nosmt      : one thread per core, never two threads on one core
+ *   numa-spread: round-robin over the NUMA nodes, one thread per core
+ *                within each node first
+ *
+ * The resulting list starts at the main CPU (--cpu) when the policy can
+ * place a worker there; worker i is pinned to cpus[i], and the process
+ * mask is the union of all of them. Without sysfs (e.g. on Darwin), the
+ * topology is flat: one package, one node and no SMT.
+*/
+
+#ifndef __COMMON_TOPO_H_
+#define __COMMON_TOPO_H_
+
+/* Standard C includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <sched.h>
+
+/* Limits */
+#define TOPO_MAX_CPUS 1024
+
+/* Placement policies */
+typedef enum {
+  PLACE_COMPACT = 0,
+  PLACE_SCATTER,
+  PLACE_NOSMT,
+  PLACE_NUMA_SPREAD
+} place_t;
+
+static const char* const place_names[] = {
+  "compact", "scatter", "nosmt", "numa-spread"
+};
+
+typedef struct {
+  int    cpu;           /* logical CPU id                         */
+  int    core;          /* core id, unique within its package     */
+  int    package;
+  int    node;
+  int    smt;           /* index among the SMT siblings of a core */
+  int    llc;           /* lowest CPU sharing the last-level cache */
+} topo_cpu_t;
+
+typedef struct {
+  int        ncpus;
+  topo_cpu_t cpus[TOPO_MAX_CPUS];
+
+  int        ncores;
+  int        npackages;
+  int        nnodes;
+  int        nllcs;
+  int        smt_ways;
+
+  /* Last-level (data or unified) cache */
+  int        llc_level;
+  size_t     llc_size;  /* in bytes */
+  size_t     line_size; /* in bytes */
+} topo_t;
+
+static inline bool place_parse(place_t* p, const char* str)
+{
+  for (int k = 0; k < (int)(sizeof(place_names) / sizeof(place_names[0])); k++) {
+    if (strcasecmp(str, place_names[k]) == 0) { *p = (place_t)k; return true; }
+  }
+
+  return false;
+}
+
+/* Read the first integer of a sysfs file; returns def if unavailable */
+static inline long __topo_read_long(const char* path, long def)
+{
+  FILE* fp = fopen(path, "r");
+  if (fp == NULL) return def;
+
+  long val = def;
+  if (fscanf(fp, "%ld", &val) != 1) val = def;
+  fclose(fp);
+
+  return val;
+}
+
+/* Read a cache size such as "32K" or "30M" in bytes */
+static inline size_t __topo_read_size(const char* path)
+{
+  FILE* fp = fopen(path, "r");
+  if (fp == NULL) return 0;
+
+  size_t val  = 0;
+  char   unit = '\0';
+  int    n    = fscanf(fp, "%zu%c", &val, &unit);
+  fclose(fp);
+
+  if (n < 1) return 0;
+  if (unit == 'K' || unit == 'k') val <<= 10;
+  if (unit == 'M' || unit == 'm') val <<= 20;
+  if (unit == 'G' || unit == 'g') val <<= 30;
+
+  return val;
+}
+
+/* Parse a CPU list such as "0-3,8,10-11" into a membership array */
+static inline int __topo_read_list(const char* path, bool* set, int max)
+{
+  FILE* fp = fopen(path, "r");
+  if (fp == NULL) return 0;
+
+  char buf[4096];
+  if (fgets(buf, sizeof(buf), fp) == NULL) buf[0] = '\0';
+  fclose(fp);
+
+  int   count = 0;
+  char* s     = buf;
+  while (*s != '\0' && *s != '\n') {
+    char* end;
+    long  lo = strtol(s, &end, 10);
+    long  hi = lo;
+    if (end == s) break;
+    if (*end == '-') {
+      s  = end + 1;
+      hi = strtol(s, &end, 10);
+    }
+    for (long c = lo; c <= hi && c < max; c++) {
+      if (c >= 0 && !set[c]) { set[c] = true; count++; }
+    }
+    s = (*end == ',') ? end + 1 : end;
+  }
+
+  return count;
+}
+
+/* Lowest CPU in a list file, or def */
+static inline int __topo_read_first(const char* path, int def)
+{
+  bool set[TOPO_MAX_CPUS] = { false };
+  if (__topo_read_list(path, set, TOPO_MAX_CPUS) == 0) return def;
+
+  for (int c = 0; c < TOPO_MAX_CPUS; c++) {
+    if (set[c]) return c;
+  }
+
+  return def;
+}
+
+static inline void topo_init(topo_t* t)
+{
+  char path[256];
+  bool online[TOPO_MAX_CPUS] = { false };
+
+  memset(t, 0, sizeof(*t));
+
+  /* CPUs we may use: online and in our affinity mask */
+  if (__topo_read_list("/sys/devices/system/cpu/online", online,
+                                                 TOPO_MAX_CPUS) == 0) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    for (long c = 0; c < n && c < TOPO_MAX_CPUS; c++) online[c] = true;
+  }
+
+#if defined(__linux__)
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+    for (int c = 0; c < TOPO_MAX_CPUS && c < CPU_SETSIZE; c++) {
+      online[c] = online[c] && CPU_ISSET(c, &allowed);
+    }
+  }
+#endif
+
+  /* Per-CPU topology */
+  for (int c = 0; c < TOPO_MAX_CPUS; c++) {
+    if (!online[c]) continue;
+
+    topo_cpu_t* p = &t->cpus[t->ncpus++];
+    p->cpu = c;
+
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/core_id", c);
+    p->core    = (int)__topo_read_long(path, c);
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", c);
+    p->package = (int)__topo_read_long(path, 0);
+    if (p->package < 0) p->package = 0;
+
+    /* SMT index: position among the siblings of this core */
+    bool sib[TOPO_MAX_CPUS] = { false };
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/thread_siblings_list", c);
+    p->smt = 0;
+    if (__topo_read_list(path, sib, TOPO_MAX_CPUS) > 0) {
+      for (int s = 0; s < c; s++) p->smt += sib[s];
+    }
+
+    /* NUMA node: the nodeN entry in the CPU directory */
+    p->node = 0;
+    for (int n = 0; n < TOPO_MAX_CPUS; n++) {
+      snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/node%d", c, n);
+      if (access(path, F_OK) == 0) { p->node = n; break; }
+    }
+
+    /* Last-level cache: the highest data or unified level */
+    p->llc = c;
+    for (int idx = 0; idx < 16; idx++) {
+      snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cache/index%d/level", c, idx);
+      int level = (int)__topo_read_long(path, -1);
+      if (level < 0) break;
+
+      snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cache/index%d/type", c, idx);
+      FILE* fp = fopen(path, "r");
+      char  type[32] = "";
+      if (fp != NULL) {
+        if (fscanf(fp, "%31s", type) != 1) type[0] = '\0';
+        fclose(fp);
+      }
+      if (strcmp(type, "Instruction") == 0) continue;
+
+      if (level >= t->llc_level) {
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cache/index%d/shared_cpu_list", c, idx);
+        p->llc = __topo_read_first(path, c);
+
+        if (level > t->llc_level || t->llc_size == 0) {
+          t->llc_level = level;
+          snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cache/index%d/size", c, idx);
+          t->llc_size  = __topo_read_size(path);
+          snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cache/index%d/coherency_line_size", c, idx);
+          t->line_size = (size_t)__topo_read_long(path, 64);
+        }
+      }
+    }
+  }
+
+  /* No usable sysfs: one CPU at least */
+  if (t->ncpus == 0) {
+    t->ncpus   = 1;
+    t->cpus[0] = (topo_cpu_t){ .cpu = 0 };
+  }
+  if (t->line_size == 0) t->line_size = 64;
+
+  /* Counts */
+  for (int i = 0; i < t->ncpus; i++) {
+    const topo_cpu_t* p = &t->cpus[i];
+    bool new_pkg = true, new_node = true, new_llc = true;
+    for (int j = 0; j < i; j++) {
+      const topo_cpu_t* q = &t->cpus[j];
+      if (q->package == p->package) new_pkg  = false;
+      if (q->node    == p->node   ) new_node = false;
+      if (q->llc     == p->llc    ) new_llc  = false;
+    }
+
+    t->npackages += new_pkg;
+    t->nnodes    += new_node;
+    t->nllcs     += new_llc;
+    t->ncores    += (p->smt == 0);
+    if (p->smt + 1 > t->smt_ways) t->smt_ways = p->smt + 1;
+  }
+  if (t->ncores == 0) t->ncores = t->ncpus;
+}
+
+/* Index of the core of p among the cores of the same package (or node) */
+static inline int __topo_core_rank(const topo_t* t, const topo_cpu_t* p,
+                                   bool by_node)
+{
+  int rank = 0;
+  for (int j = 0; j < t->ncpus; j++) {
+    const topo_cpu_t* q = &t->cpus[j];
+    if (q->smt != 0) continue;
+    if ( by_node && q->node    != p->node   ) continue;
+    if (!by_node && q->package != p->package) continue;
+
+    if (q->package < p->package ||
+        (q->package == p->package && q->core < p->core)) rank++;
+  }
+
+  return rank;
+}
+
+/* Sort key of a CPU under a placement; CPUs with a negative key are *
+ * not used by the policy.                                           */
+static inline long __topo_key(const topo_t* t, const topo_cpu_t* p, place_t pl)
+{
+  const long W = TOPO_MAX_CPUS;
+
+  switch (pl) {
+    case PLACE_SCATTER:
+      return ((long)p->smt * W + __topo_core_rank(t, p, false)) * W + p->package;
+    case PLACE_NOSMT:
+      if (p->smt != 0) return -1;
+      return ((long)p->package * W + __topo_core_rank(t, p, false)) * W;
+    case PLACE_NUMA_SPREAD:
+      return ((long)p->smt * W + __topo_core_rank(t, p, true )) * W + p->node;
+    case PLACE_COMPACT:
+    default:
+      return ((long)p->package * W + __topo_core_rank(t, p, false)) * W + p->smt;
+  }
+}
+
+/* Compute the CPUs of n workers; worker 0 lands on 'cpu'. Returns the *
+ * number of distinct CPUs; if n exceeds it, the list wraps around and  *
+ * the CPUs are oversubscribed. Returns -1, and leaves cpus untouched,  *
+ * if the policy does not use 'cpu' (e.g. a second hyperthread under    *
+ * nosmt) or it does not exist.                                          */
+static inline int topo_place(const topo_t* t, place_t pl, int cpu,
+                             int n, int* cpus)
+{
+  int  order[TOPO_MAX_CPUS];
+  long key  [TOPO_MAX_CPUS];
+  int  m = 0;
+
+  for (int i = 0; i < t->ncpus; i++) {
+    long k = __topo_key(t, &t->cpus[i], pl);
+    if (k < 0) continue;
+
+    /* Insertion sort; ties keep the CPU order */
+    int j = m++;
+    for (; j > 0 && key[j - 1] > k; j--) {
+      key[j] = key[j - 1]; order[j] = order[j - 1];
+    }
+    key[j] = k; order[j] = t->cpus[i].cpu;
+  }
+
+  /* Rotate to start at the main CPU */
+  int start = -1;
+  for (int i = 0; i < m; i++) {
+    if (order[i] == cpu) { start = i; break; }
+  }
+
+  if (start < 0) return -1;
+
+  for (int i = 0; i < n; i++) {
+    cpus[i] = order[(start + i) % m];
+  }
+
+  return m;
+}
+
+/* Information about one CPU */
+static inline const topo_cpu_t* topo_find(const topo_t* t, int cpu)
+{
+  for (int i = 0; i < t->ncpus; i++) {
+    if (t->cpus[i].cpu == cpu) return &t->cpus[i];
+  }
+
+  return NULL;
+}
+
+static inline void topo_print(const topo_t* t)
+{
+  printf("  * Topology: %d CPU(s), %d core(s), %d-way SMT, %d package(s), "
+         "%d NUMA node(s)\n", t->ncpus, t->ncores, t->smt_ways,
+                              t->npackages, t->nnodes);
+  if (t->llc_size > 0) {
+    printf("  * Last-level cache: L%d, %zu KB, %d instance(s), %zu B lines\n",
+               t->llc_level, t->llc_size >> 10, t->nllcs, t->line_size);
+  }
+}
+
+/* Print the CPU map of n workers */
+static inline void topo_print_map(const topo_t* t, place_t pl,
+                                  const int* cpus, int n)
+{
+  printf("  * CPU map (placement = %s):\n", place_names[pl]);
+  for (int i = 0; i < n; i++) {
+    const topo_cpu_t* p = topo_find(t, cpus[i]);
+
+    bool shared = false;
+    for (int j = 0; j < i; j++) shared |= (cpus[j] == cpus[i]);
+
+    if (p != NULL) {
+      printf("    + worker %3d -> cpu %3d (package %d, node %d, core %3d, "
+             "smt %d, llc %d)%s\n", i, cpus[i], p->package, p->node, p->core,
+                 p->smt, p->llc, shared ? " [oversubscribed]" : "");
+    } else {
+      printf("    + worker %3d -> cpu %3d%s\n", i, cpus[i],
+                                shared ? " [oversubscribed]" : "");
+    }
+  }
+}
+
+#endif //__COMMON_TOPO_H_
@@ -9,6 +9,9 @@
 #ifndef __COMMON_TYPES_H_
 #define __COMMON_TYPES_H_
 
+/* Fixed-width integer types */
+#include <stdint.h>
+
 typedef unsigned char byte;
 
 #endif //__COMMON_TYPES_H_
@@ -23,7 +23,7 @@
  * by\ Julien Pommier                             *
  * Website\ http://gruntthepeon.free.fr/ssemath/  *
  * ********************************************** */
-__m256 _mm256_log_ps(__m256 x)
+static inline __m256 _mm256_log_ps(__m256 x)
 {
   /* log(x) = NAN, where x is less-than-or-equal to zero */
   __m256 invalid_mask = _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_LE_OS);
@@ -88,7 +88,7 @@ __m256 _mm256_log_ps(__m256 x)
   return x;
 }
 
-__m256 _mm256_approx_log_ps(__m256 x)
+static inline __m256 _mm256_approx_log_ps(__m256 x)
 {
   /* Perform an approximation */
   /* log(x) = 2 * (sum(0, inf)((1 / 2n + 1) * ((x + 1) / (x - 1)) ^ 2n+1) */
@@ -119,7 +119,7 @@ __m256 _mm256_approx_log_ps(__m256 x)
  * by\ Julien Pommier                             *
  * Website\ http://gruntthepeon.free.fr/ssemath/  *
  * ********************************************** */
-__m256 _mm256_exp_ps(__m256 x)
+static inline __m256 _mm256_exp_ps(__m256 x)
 {
   __m256 tmp = _mm256_setzero_ps(), fx;
   __m256i imm0;
@@ -176,7 +176,7 @@ __m256 _mm256_exp_ps(__m256 x)
  * by\ Julien Pommier                             *
  * Website\ http://gruntthepeon.free.fr/ssemath/  *
  * ********************************************** */
-float32x4_t vlog_f32(float32x4_t x)
+static inline float32x4_t vlog_f32(float32x4_t x)
 {
   /* force flush to zero on denormal values */
   x = vmaxq_f32(x, vdupq_n_f32(0));
@@ -253,7 +253,7 @@ float32x4_t vlog_f32(float32x4_t x)
  * by\ Julien Pommier                             *
  * Website\ http://gruntthepeon.free.fr/ssemath/  *
  * ********************************************** */
-float32x4_t vexp_f32(float32x4_t x)
+static inline float32x4_t vexp_f32(float32x4_t x)
 {
   float32x4_t tmp, fx;
 
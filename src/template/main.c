@@ -17,9 +17,12 @@
  * record the runtime of _each_ invocation through the following Linux
  * API:
  *    clock_gettime(), with the clk_id set to CLOCK_MONOTONIC
- * Then, the file will calculate the standard deviation and calculate
- * an outlier-free average by excluding runtimes that are larger than
- * 2 standard deviation of the original average.
+ * or, with "--timer tsc", the serialized time-stamp counter (see
+ * common/timer.h).
+ * Then, the file will report robust statistics (min, median and its
+ * bootstrap confidence interval, tail percentiles and MAD) alongside
+ * an outlier-free average that excludes runtimes more than nstdevs
+ * standard deviations away from the average (see common/stats.h).
  */
 
 /* Set features         */
@@ -52,12 +55,45 @@
 /* Include common headers */
 #include "common/types.h"
 #include "common/macros.h"
+#include "common/perf.h"
+#include "common/timer.h"
+#include "common/stats.h"
+#include "common/impl.h"
+#include "common/arena.h"
+#include "common/topo.h"
+#include "common/rng.h"
+#include "common/bench.h"
 
 /* Include application-specific headers */
 #include "include/types.h"
 
 const int SIZE_DATA = 4 * 1024 * 1024;
 
+/* Output of the measured runs, for the callbacks of common/bench.h */
+typedef struct {
+  const args_t* args;
+  const byte*   ref;
+} output_t;
+
+/* Clear the output of args and set its guard */
+static void output_reset(void* ctx)
+{
+  const args_t* args = ((output_t*)ctx)->args;
+
+  memset(args->output, 0, args->size);
+  __SET_GUARD(args->output, args->size);
+}
+
+/* The output of args matches the reference and its guard is intact */
+static bool output_check(void* ctx)
+{
+  const output_t* o    = (output_t*)ctx;
+  const args_t*   args = o->args;
+
+  return __CHECK_MATCH(o->ref, args->output, args->size) &&
+         __CHECK_GUARD(args->output, args->size);
+}
+
 int main(int argc, char** argv)
 {
   /* Set the buffer for printf to NULL */
@@ -67,38 +103,57 @@ int main(int argc, char** argv)
   int nthreads = 1;
   int cpu      = 0;
 
+  place_t placement = PLACE_COMPACT;
+
   int nruns    = 10000;
   int nstdevs  = 3;
 
+  int nreps         = 0;
+  int min_sample_us = 50;
+  int warmup_ms     = 500;
+
   /* Data */
-  int data_size = SIZE_DATA;
+  size_t data_size = SIZE_DATA;
 
   /* Parse arguments */
-  /* Function pointers */
-  void* (*impl_scalar_naive_ptr)(void* args) = impl_scalar_naive;
-  void* (*impl_scalar_opt_ptr  )(void* args) = impl_scalar_opt;
-  void* (*impl_vector_ptr      )(void* args) = impl_vector;
-  void* (*impl_parallel_ptr    )(void* args) = impl_parallel;
+  /* Implementations */
+  const impl_t impls[] = {
+    { "naive", "scalar_naive", impl_scalar_naive },
+    { "opt"  , "scalar_opt"  , impl_scalar_opt   },
+    { "vec"  , "vectorized"  , impl_vector       },
+    { "para" , "parallelized", impl_parallel     },
+  };
+  const int nimpls = sizeof(impls) / sizeof(impl_t);
 
   /* Chosen */
-  void* (*impl)(void* args) = NULL;
-  const char* impl_str      = NULL;
+  int  sel[IMPL_MAX];
+  int  nsel = 0;
+
+  /* Interleaved A/B comparison */
+  int  ab_sel[IMPL_MAX];
+  int  nab  = 0;
+
+  bool parse_args_err       = false;
+
+  /* Performance counters */
+  perf_group_t perf;
+  perf_init(&perf);
+
+  /* Timer */
+  timer_cfg_t timer;
+  timer_init(&timer);
 
   bool help = false;
   for (int i = 1; i < argc; i++) {
     /* Implementations */
     if (strcmp(argv[i], "-i") == 0 || strcmp(argv[i], "--impl") == 0) {
       assert (++i < argc);
-      if (strcmp(argv[i], "naive") == 0) {
-        impl = impl_scalar_naive_ptr; impl_str = "scalar_naive";
-      } else if (strcmp(argv[i], "opt"  ) == 0) {
-        impl = impl_scalar_opt_ptr  ; impl_str = "scalar_opt"  ;
-      } else if (strcmp(argv[i], "vec"  ) == 0) {
-        impl = impl_vector_ptr      ; impl_str = "vectorized"  ;
-      } else if (strcmp(argv[i], "para" ) == 0) {
-        impl = impl_parallel_ptr    ; impl_str = "parallelized";
-      } else {
-        impl = NULL                 ; impl_str = "unknown"     ;
+      char bad[64];
+      if (!impl_parse(impls, nimpls, argv[i], sel, &nsel, bad, sizeof(bad))) {
+        printf("\n");
+        printf("ERROR: Unknown \"%s\" implementation.\n", bad);
+
+        parse_args_err = true;
       }
 
       continue;
@@ -107,7 +162,16 @@ int main(int argc, char** argv)
     /* Input/output data size */
     if (strcmp(argv[i], "-s") == 0 || strcmp(argv[i], "--size") == 0) {
       assert (++i < argc);
-      data_size = atoi(argv[i]);
+      char* end;
+      unsigned long long nbytes = strtoull(argv[i], &end, 0);
+      if (*end != '\0' || nbytes == 0 || nbytes > SIZE_MAX - 64) {
+        printf("\n");
+        printf("ERROR: Invalid size \"%s\" (must be > 0 and fit in memory)\n", argv[i]);
+
+        parse_args_err = true;
+      } else {
+        data_size = nbytes;
+      }
 
       continue;
     }
@@ -127,6 +191,73 @@ int main(int argc, char** argv)
       continue;
     }
 
+    if (strcmp(argv[i], "--reps") == 0) {
+      assert (++i < argc);
+      nreps = atoi(argv[i]);
+
+      continue;
+    }
+
+    if (strcmp(argv[i], "--min-sample-us") == 0) {
+      assert (++i < argc);
+      min_sample_us = atoi(argv[i]);
+
+      continue;
+    }
+
+    if (strcmp(argv[i], "--warmup-ms") == 0) {
+      assert (++i < argc);
+      warmup_ms = atoi(argv[i]);
+
+      continue;
+    }
+
+    /* Interleaved A/B comparison */
+    if (strcmp(argv[i], "--ab") == 0) {
+      assert (++i < argc);
+      char bad[64];
+      if (!impl_parse(impls, nimpls, argv[i], ab_sel, &nab, bad, sizeof(bad))) {
+        printf("\n");
+        printf("ERROR: Unknown \"%s\" implementation.\n", bad);
+
+        parse_args_err = true;
+      } else if (nab < 2) {
+        printf("\n");
+        printf("ERROR: --ab needs at least two implementations.\n");
+
+        parse_args_err = true;
+      }
+
+      continue;
+    }
+
+    /* Timer source */
+    if (strcmp(argv[i], "--timer") == 0) {
+      assert (++i < argc);
+      if (!timer_parse(&timer, argv[i])) {
+        printf("\n");
+        printf("ERROR: Unknown timer \"%s\"\n", argv[i]);
+
+        parse_args_err = true;
+      }
+
+      continue;
+    }
+
+    /* Performance counters */
+    if (strcmp(argv[i], "--counters") == 0) {
+      assert (++i < argc);
+      char bad[64];
+      if (!perf_parse(&perf, argv[i], bad, sizeof(bad))) {
+        printf("\n");
+        printf("ERROR: Unknown performance counter \"%s\"\n", bad);
+
+        parse_args_err = true;
+      }
+
+      continue;
+    }
+
     /* Parallelization */
     if (strcmp(argv[i], "-n") == 0 || strcmp(argv[i], "--nthreads") == 0) {
       assert (++i < argc);
@@ -135,6 +266,18 @@ int main(int argc, char** argv)
       continue;
     }
 
+    if (strcmp(argv[i], "--placement") == 0) {
+      assert (++i < argc);
+      if (!place_parse(&placement, argv[i])) {
+        printf("\n");
+        printf("ERROR: Unknown placement \"%s\"\n", argv[i]);
+
+        parse_args_err = true;
+      }
+
+      continue;
+    }
+
     if (strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "--cpu") == 0) {
       assert (++i < argc);
       cpu = atoi(argv[i]);
@@ -150,35 +293,63 @@ int main(int argc, char** argv)
     }
   }
 
-  if (help || impl == NULL) {
-    if (!help) {
-      if (impl_str != NULL) {
-        printf("\n");
-        printf("ERROR: Unknown \"%s\" implementation.\n", impl_str);
-      } else {
-        printf("\n");
-        printf("ERROR: No implementation was chosen.\n");
-      }
-    }
+  if (!parse_args_err && !help && nsel == 0 && nab == 0) {
+    printf("\n");
+    printf("ERROR: No implementation was chosen.\n");
+  }
+
+  if (help || (nsel == 0 && nab == 0) || parse_args_err) {
     printf("\n");
     printf("Usage:\n");
-    printf("  %s {-i | --impl} impl_str [Options]\n", argv[0]);
+    printf("  %s {-i | --impl} impl_str[,impl_str...] [Options]\n", argv[0]);
     printf("  \n");
     printf("  Required:\n");
-    printf("    -i | --impl      Available implementations = {naive, opt, vec, para}\n");
+    printf("    -i | --impl      Available implementations = {");
+    impl_print_names(impls, nimpls);
+    printf("}\n");
+    printf("                     A comma-separated list or \"all\" runs several in one process.\n");
+    printf("                     (not required with --ab)\n");
     printf("    \n");
     printf("  Options:\n");
     printf("    -h | --help      Print this message\n");
     printf("    -n | --nthreads  Set number of threads available (default = %d)\n", nthreads);
     printf("    -c | --cpu       Set the main CPU for the program (default = %d)\n", cpu);
-    printf("    -s | --size      Size of input and output data (default = %d)\n", data_size);
+    printf("         --placement  Placement of the worker threads on the CPUs (default = %s)\n", place_names[placement]);
+    printf("                     Available placements = {compact, scatter, nosmt, numa-spread}.\n");
+    printf("    -s | --size      Size of input and output data (default = %zu)\n", data_size);
     printf("         --nruns     Number of runs to the implementation (default = %d)\n", nruns);
     printf("         --stdevs    Number of standard deviation to exclude outliers (default = %d)\n", nstdevs);
+    printf("         --reps      Invocations per run; 0 calibrates it automatically (default = %d)\n", nreps);
+    printf("         --min-sample-us  Minimum duration of a run when calibrating --reps (default = %d)\n", min_sample_us);
+    printf("         --warmup-ms Maximum time spent warming up; 0 disables warmup (default = %d)\n", warmup_ms);
+    printf("         --ab        Interleave runs of a comma-separated list of implementations in a\n");
+    printf("                     randomized order and report paired differences (e.g. vec,para)\n");
+    printf("         --timer     Timer used to time each run (default = %s)\n", __timer_name(timer.src));
+    printf("                     Available timers = {clock, tsc}.\n");
+    printf("         --counters  Comma-separated performance counters to collect (default = none)\n");
+    printf("                     Available counters = {cycles, instructions, llc-misses,\n");
+    printf("                     branch-misses, dtlb-misses, page-faults, context-switches}.\n");
     printf("\n");
 
     exit(help? 0 : 1);
   }
 
+  /* Topology and thread placement; worker i runs on worker_cpus[i] */
+  topo_t topo;
+  topo_init(&topo);
+
+  int nworkers = nthreads;
+  if (nworkers > TOPO_MAX_CPUS) nworkers = TOPO_MAX_CPUS;
+
+  int worker_cpus[TOPO_MAX_CPUS];
+  if (topo_place(&topo, placement, cpu, nworkers, worker_cpus) < 0) {
+    printf("\n");
+    printf("ERROR: CPU %d is not used by the \"%s\" placement (--cpu)\n",
+                                               cpu, place_names[placement]);
+
+    exit(1);
+  }
+
   /* Set our priority the highest */
   int nice_level = -20;
 
@@ -218,8 +389,8 @@ int main(int argc, char** argv)
   cpu_set_t cpumask;
 
   CPU_ZERO(&cpumask);
-  for (int i = 0; i < nthreads; i++) {
-    CPU_SET(cpu + i, &cpumask);
+  for (int i = 0; i < nworkers; i++) {
+    CPU_SET(worker_cpus[i], &cpumask);
   }
 
   res = sched_setaffinity(pid, sizeof(cpumask), &cpumask);
@@ -230,18 +401,38 @@ int main(int argc, char** argv)
     printf("Succeeded\n");
   }
 #endif
+  topo_print(&topo);
+  topo_print_map(&topo, placement, worker_cpus, nworkers);
   printf("\n");
 
   /* Statistics */
   __DECLARE_STATS(nruns, nstdevs);
 
-  /* Initialize Rand */
-  srand(0xdeadbeef);
+  /* Timer */
+  printf("Calibrating the \"%s\" timer:\n", __timer_name(timer.src));
+  timer_calibrate(&timer);
+  if (timer.src == TIMER_TSC) {
+    printf("  * TSC frequency = %.3f MHz (%s)\n", 1e3 / timer.ns_per_tick,
+                             timer.invariant ? "invariant" : "NOT invariant");
+  }
+  printf("  * Timer source = %s\n", __timer_name(timer.src));
+  printf("  * Timer overhead = %.1f ns (subtracted from every run)\n",
+                                       timer.overhead * timer.ns_per_tick);
+  printf("\n");
+
+  /* Performance counters */
+  if (perf.nevents > 0) {
+    printf("Setting up performance counters:\n");
+    printf("  * Opening a group of %d counter(s):\n", perf.nevents);
+    perf_open(&perf);
+    printf("  * Counting %d counter(s)\n", perf.nevents);
+    printf("\n");
+  }
 
   /* Datasets */
   /* Allocation and initialization */
-  byte* src   = __ALLOC_INIT_DATA(byte, data_size + 0);
-  byte* ref   = __ALLOC_INIT_DATA(byte, data_size + 4);
+  byte* src   = __ALLOC_INIT_DATA(byte, data_size + 0, 0);
+  byte* ref   = __ALLOC_INIT_DATA(byte, data_size + 4, 1);
   byte* dest  = __ALLOC_DATA     (byte, data_size + 4);
 
   /* Setting a guards, which is 0xdeadcafe.
@@ -274,152 +465,126 @@ int main(int argc, char** argv)
   args.cpu      = cpu;
   args.nthreads = nthreads;
 
-  /* Start execution */
-  printf("Running \"%s\" implementation:\n", impl_str);
-
-  printf("  * Invoking the implementation %d times .... ", num_runs);
-  for (int i = 0; i < num_runs; i++) {
-    __SET_START_TIME();
-    for (int j = 0; j < 16; j++) {
-      (*impl)(&args);
-    }
-    __SET_END_TIME();
-    runtimes[i] = __CALC_RUNTIME() / 16;
-  }
-  printf("Finished\n");
-
-  /* Verfication */
-  printf("  * Verifying results .... ");
-  bool match = __CHECK_MATCH(ref, dest, data_size);
-  bool guard = __CHECK_GUARD(     dest, data_size);
-  if (match && guard) {
-    printf("Success\n");
-  } else if (!match && guard) {
-    printf("Fail, but no buffer overruns\n");
-  } else if (match && !guard) {
-    printf("Success, but failed buffer overruns check\n");
-  } else if(!match && !guard) {
-    printf("Failed, and failed buffer overruns check\n");
-  }
-
-  /* Running analytics */
-  uint64_t min     = -1;
-  uint64_t max     =  0;
-
-  uint64_t avg     =  0;
-  uint64_t avg_n   =  0;
-
-  uint64_t std     =  0;
-  uint64_t std_n   =  0;
-
-  int      n_msked =  0;
-  int      n_stats =  0;
-
-  for (int i = 0; i < num_runs; i++)
-    runtimes_mask[i] = true;
-
-  printf("  * Running statistics:\n");
-  do {
-    n_stats++;
-    printf("    + Starting statistics run number #%d:\n", n_stats);
-    avg_n =  0;
-    avg   =  0;
-
-    /*   -> Calculate min, max, and avg */
-    for (int i = 0; i < num_runs; i++) {
-      if (runtimes_mask[i]) {
-        if (runtimes[i] < min) {
-          min = runtimes[i];
-        }
-        if (runtimes[i] > max) {
-          max = runtimes[i];
-        }
-        avg += runtimes[i];
-        avg_n += 1;
+  /* Measurement loops on the output of args */
+  output_t out;
+
+  out.args = &args;
+  out.ref  = ref;
+
+  bench_t bench;
+
+  bench.timer         = &timer;
+  bench.perf          = &perf;
+  bench.runtimes      = runtimes;
+  bench.runtimes_mask = runtimes_mask;
+  bench.counters      = counters;
+  bench.num_runs      = num_runs;
+  bench.nstd          = nstd;
+  bench.nelems        = data_size;
+  bench.nreps         = nreps;
+  bench.min_sample_us = min_sample_us;
+  bench.warmup_ms     = warmup_ms;
+  bench.prefault      = false;
+  bench.faults_failed = false;
+  bench.verbose       = false;
+  bench.reset         = output_reset;
+  bench.check         = output_check;
+  bench.ctx           = &out;
+
+  /* Run all selected implementations on the same buffers */
+  double medians[IMPL_MAX];
+  bool   matches[IMPL_MAX];
+
+  /* Follow every step of the measurement */
+  bench.verbose = true;
+
+  for (int k = 0; k < nsel; k++) {
+    void* (*impl)(void* args) = impls[sel[k]].fn;
+    const char* impl_str      = impls[sel[k]].str;
+
+    /* Start execution */
+    printf("Running \"%s\" implementation:\n", impl_str);
+    bench_point_t pt = bench_measure(&bench, impl, &args);
+
+    /* Running analytics */
+    stats_t stats = pt.stats;
+
+    printf("  * Running statistics:\n");
+    stats_print(&stats);
+
+    /* Display information */
+    printf("  * Runtimes (%s): ", __PRINT_MATCH(pt.match));
+    printf(" %.1f ns\n"        , stats.median        );
+
+    /* Performance counters */
+    perf_summary(&perf, counters, runtimes_mask, num_runs, data_size);
+
+    /* Dump */
+    printf("  * Dumping runtime informations:\n");
+    FILE * fp;
+    char filename[256];
+    strcpy(filename, impl_str);
+    strcat(filename, "_runtimes.csv");
+    printf("    - Filename: %s\n", filename);
+    printf("    - Opening file .... ");
+    fp = fopen(filename, "w");
+
+    if (fp != NULL) {
+      printf("Succeeded\n");
+      printf("    - Writing runtimes ... ");
+      fprintf(fp, "impl,%s", impl_str);
+
+      fprintf(fp, "\n");
+      fprintf(fp, "timer,%s", __timer_name(timer.src));
+
+      fprintf(fp, "\n");
+      fprintf(fp, "timer_overhead_ns,%f", timer.overhead * timer.ns_per_tick);
+
+      fprintf(fp, "\n");
+      fprintf(fp, "num_of_runs,%d", num_runs);
+
+      fprintf(fp, "\n");
+      fprintf(fp, "invocations_per_run,%d", pt.reps);
+
+      fprintf(fp, "\n");
+      fprintf(fp, "runtimes");
+      for (int i = 0; i < num_runs; i++) {
+        fprintf(fp, ", ");
+        fprintf(fp, "%.3f", runtimes[i]);
       }
-    }
-    avg = avg / avg_n;
 
-    /*   -> Calculate standard deviation */
-    std   =  0;
-    std_n =  0;
-
-    for (int i = 0; i < num_runs; i++) {
-      if (runtimes_mask[i]) {
-        std   += ((runtimes[i] - avg) *
-                  (runtimes[i] - avg));
-        std_n += 1;
-      }
-    }
-    std = sqrt(std / std_n);
-
-    /*   -> Calculate outlier-free average (mean) */
-    n_msked = 0;
-    for (int i = 0; i < num_runs; i++) {
-      if (runtimes_mask[i]) {
-        if (runtimes[i] > avg) {
-          if ((runtimes[i] - avg) > (nstd * std)) {
-            runtimes_mask[i] = false;
-            n_msked += 1;
-          }
-        } else {
-          if ((avg - runtimes[i]) > (nstd * std)) {
-            runtimes_mask[i] = false;
-            n_msked += 1;
-          }
-        }
-      }
+      stats_dump(fp, &stats);
+      perf_dump(fp, &perf, counters, runtimes_mask, num_runs, data_size);
+      printf("Finished\n");
+      printf("    - Closing file handle .... ");
+      fclose(fp);
+      printf("Finished\n");
+    } else {
+      printf("Failed\n");
     }
+    printf("\n");
 
-    printf("      - Standard deviation = %" PRIu64 "\n", std);
-    printf("      - Average = %" PRIu64 "\n", avg);
-    printf("      - Number of active elements = %" PRIu64 "\n", avg_n);
-    printf("      - Number of masked-off = %d\n", n_msked);
-  } while (n_msked > 0);
-  /* Display information */
-  printf("  * Runtimes (%s): ", __PRINT_MATCH(match));
-  printf(" %" PRIu64 " ns\n"  , avg                 );
-
-  /* Dump */
-  printf("  * Dumping runtime informations:\n");
-  FILE * fp;
-  char filename[256];
-  strcpy(filename, impl_str);
-  strcat(filename, "_runtimes.csv");
-  printf("    - Filename: %s\n", filename);
-  printf("    - Opening file .... ");
-  fp = fopen(filename, "w");
-
-  if (fp != NULL) {
-    printf("Succeeded\n");
-    printf("    - Writing runtimes ... ");
-    fprintf(fp, "impl,%s", impl_str);
+    medians[k] = stats.median;
+    matches[k] = pt.match;
+  }
 
-    fprintf(fp, "\n");
-    fprintf(fp, "num_of_runs,%d", num_runs);
+  bench.verbose = false;
 
-    fprintf(fp, "\n");
-    fprintf(fp, "runtimes");
-    for (int i = 0; i < num_runs; i++) {
-      fprintf(fp, ", ");
-      fprintf(fp, "%" PRIu64 "", runtimes[i]);
-    }
+  /* Comparison table */
+  if (nsel > 1) {
+    impl_summary(impls, sel, nsel, medians, matches,
+                 2.0 * data_size, 1.0, "GB/s");
+  }
 
-    fprintf(fp, "\n");
-    fprintf(fp, "avg,%" PRIu64 "", avg);
-    printf("Finished\n");
-    printf("    - Closing file handle .... ");
-    fclose(fp);
-    printf("Finished\n");
-  } else {
-    printf("Failed\n");
+  /* Interleaved A/B comparison */
+  if (nab > 0) {
+    bench_ab(&bench, impls, ab_sel, nab, &args);
   }
-  printf("\n");
 
   /* Manage memory */
-  free(src);
-  free(dest);
-  free(ref);
+  __FREE_DATA(src);
+  __FREE_DATA(dest);
+  __FREE_DATA(ref);
 
   /* Finished with statistics */
   __DESTROY_STATS();
@@ -15,27 +15,39 @@
 
 /* Include application-specific headers */
 #include "include/types.h"
+#include "include/elem.h"
 
 /* Naive Implementation */
 #pragma GCC push_options
 #pragma GCC optimize ("O1")
+/* Naive kernel for elements of type T */
+#define __NAIVE_KERNEL(sfx, T)                                              \
+__attribute__ ((optimize(1)))                                               \
+static void* __impl_scalar_naive_##sfx(args_t* parsed_args)                \
+{                                                                           \
+  /* Get all the arguments */                                               \
+  register       T*     dest = (      T*)(parsed_args->output);             \
+  register const T*     src0 = (const T*)(parsed_args->input0);             \
+  register const T*     src1 = (const T*)(parsed_args->input1);             \
+  register       size_t size =            parsed_args->size / sizeof(T);    \
+                                                                            \
+  for (register size_t i = 0; i < size; i++) {                              \
+    dest[i] = src0[i] + src1[i];                                            \
+  }                                                                         \
+                                                                            \
+  /* Done */                                                                \
+  return NULL;                                                              \
+}
+
+ELEM_INSTANTIATE(__NAIVE_KERNEL)
+
 __attribute__ ((optimize(1)))
 void* impl_scalar_naive(void* args)
 {
   /* Get the argument struct */
   args_t* parsed_args = (args_t*)args;
 
-  /* Get all the arguments */
-  register       int*   dest = (      int*)(parsed_args->output);
-  register const int*   src0 = (const int*)(parsed_args->input0);
-  register const int*   src1 = (const int*)(parsed_args->input1);
-  register       size_t size =              parsed_args->size / 4;
-
-  for (register int i = 0; i < size; i++) {
-    dest[i] = src0[i] + src1[i];
-  }
-
-  /* Done */
-  return NULL;
+  /* Run the kernel of the element type */
+  ELEM_DISPATCH(__impl_scalar_naive, parsed_args);
 }
 #pragma GCC pop_options
@@ -17,6 +17,8 @@
 /* Include common headers */
 #include "common/macros.h"
 #include "common/types.h"
+#include "common/timer.h"
+#include "common/pool.h"
 
 /* If we are on Darwin, include the compatibility header */
 #if defined(__APPLE__)
@@ -25,20 +27,43 @@
 
 /* Include application-specific headers */
 #include "include/types.h"
+#include "include/elem.h"
+
+/* Kernel of one worker for elements of type T */
+#define __WORKER_KERNEL(sfx, T)                                             \
+static void* __worker_##sfx(args_t* p_args)                                 \
+{                                                                           \
+  /* Get all the arguments */                                               \
+  register       T*     dest = (      T*)(p_args->output);                  \
+  register const T*     src0 = (const T*)(p_args->input0);                  \
+  register const T*     src1 = (const T*)(p_args->input1);                  \
+  register       size_t size =            p_args->size / sizeof(T);         \
+                                                                            \
+  for (size_t i = 0; i < size; i++) {                                       \
+    dest[i] = src0[i] + src1[i];                                            \
+  }                                                                         \
+                                                                            \
+  return NULL;                                                              \
+}
+
+ELEM_INSTANTIATE(__WORKER_KERNEL)
+
+static void* __worker(args_t* p_args)
+{
+  ELEM_DISPATCH(__worker, p_args);
+}
 
 /* Alternative Implementation */
 void* worker(void* args) {
   /* Parse the arguments structure */
   args_t *p_args = (args_t*)args;
 
-  /* Get all the arguments */
-  register       int*   dest = (      int*)(p_args->output);
-  register const int*   src0 = (const int*)(p_args->input0);
-  register const int*   src1 = (const int*)(p_args->input1);
-  register       size_t size =              p_args->size;
+  uint64_t t0 = (p_args->worker_ns != NULL) ? timer_clock_ns() : 0;
+
+  __worker(p_args);
 
-  for (int i = 0; i < size; i++) {
-    dest[i] = src0[i] + src1[i];
+  if (p_args->worker_ns != NULL) {
+    *(p_args->worker_ns) += timer_clock_ns() - t0;
   }
 
   return NULL;
@@ -50,10 +75,11 @@ void* impl_parallel(void* args)
   args_t* p_args = (args_t*)args;
 
   /* Get all the arguments */
-  register       int*   dest = (      int*)(p_args->output);
-  register const int*   src0 = (const int*)(p_args->input0);
-  register const int*   src1 = (const int*)(p_args->input1);
-  register       size_t size =              p_args->size / 4;
+  register       byte*  dest = p_args->output;
+  register       byte*  src0 = p_args->input0;
+  register       byte*  src1 = p_args->input1;
+  register       size_t esz  = elem_sizes[p_args->type];
+  register       size_t size = p_args->size / esz;
 
   register       size_t nthreads = p_args->nthreads;
   register       size_t cpu      = p_args->cpu;
@@ -61,26 +87,46 @@ void* impl_parallel(void* args)
   /* Create all threads */
   pthread_t tid[nthreads];
   args_t    targs[nthreads];
+  void*     pargs[nthreads];
   cpu_set_t cpuset[nthreads];
 
-  /* Amount of work per thread */
+  /* Amount of work per thread, in whole elements; the last one takes *
+   * the trailing elements                                             */
   size_t size_per_thread = size / nthreads;
   size_t remaining = size % nthreads;
 
   for (int i = 0; i < nthreads; i++) {
     /* Initialize the argument structure */
-    targs[i].size     = size_per_thread;
-    targs[i].output   = (byte*)dest;
-    targs[i].input0   = (byte*)src0;
-    targs[i].input1   = (byte*)src1;
+    targs[i].size     = (size_per_thread + ((i == nthreads - 1) ? remaining : 0)) * esz;
+    targs[i].output   = dest;
+    targs[i].input0   = src0;
+    targs[i].input1   = src1;
+    targs[i].type     = p_args->type;
 
     dest += targs[i].size;
     src0 += targs[i].size;
     src1 += targs[i].size;
 
-    targs[i].cpu      = (cpu + i) % nthreads;
+    targs[i].cpu      = (p_args->cpus != NULL) ? p_args->cpus[i] : (cpu + i);
     targs[i].nthreads = nthreads;
+    targs[i].cpus     = NULL;
+    targs[i].pool     = NULL;
+
+    targs[i].worker_ns = (p_args->worker_ns != NULL) ? &(p_args->worker_ns[i])
+                                                     : NULL;
+
+    pargs[i] = (void*)&targs[i];
+  }
+
+  /* Persistent pool: workers are already pinned and waiting */
+  if (p_args->pool != NULL) {
+    pool_run(p_args->pool, worker, pargs, nthreads);
 
+    return NULL;
+  }
+
+  /* Otherwise, spawn (and pin) the threads for this call only */
+  for (int i = 0; i < nthreads; i++) {
     /* Affinity */
     CPU_ZERO(&(cpuset[i]));
     CPU_SET(targs[i].cpu, &(cpuset[i]));
@@ -90,31 +136,20 @@ void* impl_parallel(void* args)
       tid[i] = pthread_self();
     } else {
       int __attribute__((unused)) res = \
-                         pthread_create(&tid[i], NULL, worker, (void*)&targs[i]);
+                         pthread_create(&tid[i], NULL, worker, pargs[i]);
     }
 
     int __attribute__((unused)) res_affinity = pthread_setaffinity_np(tid[i],
                                                 sizeof(cpuset[i]), &(cpuset[i]));
   }
 
+  /* Perform one portion of the work */
   if (nthreads > 0) {
-    /* Perform one portion of the work */
-    for (int i = 0; i < targs[0].size; i++) {
-      ((int*)targs[0].output)[i] =                            \
-                          ((const int*)targs[0].input0)[i] +  \
-                              ((const int*)targs[0].input1)[i];
-    }
-
-    /* Perform trailing elements */
-    for (int i = size - remaining; i < size; i++) {
-      ((int*)targs[0].output)[i] =                            \
-                          ((const int*)targs[0].input0)[i] +  \
-                              ((const int*)targs[0].input1)[i];
-    }
+    worker(pargs[0]);
   }
 
   /* Wait for all threads to finish execution */
-  for (int i = 0; i < nthreads; i++) {
+  for (int i = 1; i < nthreads; i++) {
     pthread_join(tid[i], NULL);
   }
 
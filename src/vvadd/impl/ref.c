@@ -18,23 +18,34 @@
 
 /* Include application-specific headers */
 #include "include/types.h"
+#include "include/elem.h"
 
 /* Reference Implementation */
+/* Reference kernel for elements of type T */
+#define __REF_KERNEL(sfx, T)                                                \
+static void* __impl_ref_##sfx(args_t* parsed_args)                          \
+{                                                                           \
+  /* Get all the arguments */                                               \
+  register       T*     dest = (      T*)(parsed_args->output);             \
+  register const T*     src0 = (const T*)(parsed_args->input0);             \
+  register const T*     src1 = (const T*)(parsed_args->input1);             \
+  register       size_t size =            parsed_args->size / sizeof(T);    \
+                                                                            \
+  for (register size_t i = 0; i < size; i++) {                              \
+    dest[i] = src0[i] + src1[i];                                            \
+  }                                                                         \
+                                                                            \
+  /* Done */                                                                \
+  return NULL;                                                              \
+}
+
+ELEM_INSTANTIATE(__REF_KERNEL)
+
 void* impl_ref(void* args)
 {
   /* Get the argument struct */
   args_t* parsed_args = (args_t*) args;
 
-  /* Get all the arguments */
-  register       int*   dest = (      int*)(parsed_args->output);
-  register const int*   src0 = (const int*)(parsed_args->input0);
-  register const int*   src1 = (const int*)(parsed_args->input1);
-  register       size_t size =              parsed_args->size / 4;
-
-  for (register int i = 0; i < size; i++) {
-    dest[i] = src0[i] + src1[i];
-  }
-
-  /* Done */
-  return NULL;
+  /* Run the kernel of the element type */
+  ELEM_DISPATCH(__impl_ref, parsed_args);
 }
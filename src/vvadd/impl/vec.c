@@ -23,6 +23,43 @@
 
 /* Include application-specific headers */
 #include "include/types.h"
+#include "include/elem.h"
+
+#if defined(__amd64__) || defined(__x86_64__)
+/* Vectorized kernel for elements of type T; every load and store is *
+ * masked, and the last partial vector goes through __vtail_<sfx>.    */
+#define __VEC_KERNEL(sfx, T)                                                \
+static void* __impl_vector_##sfx(args_t* parsed_args)                       \
+{                                                                           \
+  /* Get all the arguments */                                               \
+  register       T*     dest = (      T*)(parsed_args->output);             \
+  register const T*     src0 = (const T*)(parsed_args->input0);             \
+  register const T*     src1 = (const T*)(parsed_args->input1);             \
+  register       size_t size =            parsed_args->size / sizeof(T);    \
+                                                                            \
+  __m256i vm = _mm256_set1_epi32(0x80000000);                               \
+  const size_t max_vlen = 32 / sizeof(T);                                   \
+                                                                            \
+  register size_t i = 0;                                                    \
+  for (; i + max_vlen <= size; i += max_vlen) {                             \
+    __m256i vec0 = _mm256_maskload_epi32((const int*)(src0 + i), vm);       \
+    __m256i vec1 = _mm256_maskload_epi32((const int*)(src1 + i), vm);       \
+                                                                            \
+    __m256i res  = __vadd_##sfx(vec0, vec1);          /* Do the compute */  \
+                                                                            \
+    _mm256_maskstore_epi32((int*)(dest + i), vm, res);  /* Store output */  \
+  }                                                                         \
+                                                                            \
+  if (i < size) {                                                           \
+    __vtail_##sfx(dest + i, src0 + i, src1 + i, size - i);                  \
+  }                                                                         \
+                                                                            \
+  /* Done */                                                                \
+  return NULL;                                                              \
+}
+
+ELEM_INSTANTIATE(__VEC_KERNEL)
+#endif
 
 /* Alternative Implementation */
 void* impl_vector(void* args)
@@ -31,41 +68,8 @@ void* impl_vector(void* args)
   /* Get the argument struct */
   args_t* parsed_args = (args_t*)args;
 
-  /* Get all the arguments */
-  register       int*   dest = (      int*)(parsed_args->output);
-  register const int*   src0 = (const int*)(parsed_args->input0);
-  register const int*   src1 = (const int*)(parsed_args->input1);
-  register       size_t size =              parsed_args->size / 4;
-
-  __m256i vm = _mm256_set1_epi32(0x80000000);
-  const int max_vlen = 32 / sizeof(int);
-
-  for (register size_t hw_vlen, i = 0; i < size; i += hw_vlen) {
-
-    register int rem = size - i;
-    hw_vlen = rem < max_vlen ? rem : max_vlen;        /* num of elems      */
-    if (hw_vlen < max_vlen) {
-      unsigned int m[max_vlen];
-      for (size_t j = 0; j < max_vlen; j++)
-        m[j] = (j < hw_vlen) ? 0x80000000 : 0x00000000;
-      vm = _mm256_setr_epi32(m[0], m[1], m[2], m[3],
-                             m[4], m[5], m[6], m[7]);
-    }
-
-    __m256i vec0 = _mm256_maskload_epi32(src0, vm);   /* Load vectors from */
-    __m256i vec1 = _mm256_maskload_epi32(src1, vm);   /* src0 and src1     */
-
-    __m256i res  = _mm256_add_epi32(vec0, vec1);      /* Do the compute    */
-
-    _mm256_maskstore_epi32(dest, vm, res);            /* Store output      */
-
-    src0 += hw_vlen;                                  /* -\                */
-    src1 += hw_vlen;                                  /*   |-> ptr arith   */
-    dest += hw_vlen;                                  /* -/                */
-  }
-
-  /* Done */
-  return NULL;
+  /* Run the kernel of the element type */
+  ELEM_DISPATCH(__impl_vector, parsed_args);
 #elif defined(__aarch__) || defined(__aarch64__) || defined(__arm64__)
 #endif
 }
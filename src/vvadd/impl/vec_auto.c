@@ -0,0 +1,45 @@
+/* vec_auto.c
+ *
+ * Author: Khalid Al-Hawaj
+ * Date  : 16 Oct. 2026
+ *
+ * Vectorized implementation that picks its stores by the working-set
+ * size: regular stores (impl_vector) while the two inputs and the output
+ * fit in the last-level cache, where the output is likely to be read
+ * again from it, and streaming stores (impl_vector_nt) beyond it, where
+ * every store would otherwise pay for a read for ownership.
+ */
+
+/* Standard C includes */
+#include <stdlib.h>
+
+/* Include common headers */
+#include "common/macros.h"
+#include "common/types.h"
+
+/* Include application-specific headers */
+#include "include/types.h"
+#include "impl/vec.h"
+#include "impl/vec_nt.h"
+
+/* Last-level cache size when it could not be detected */
+#define VEC_AUTO_LLC_DEFAULT (8llu << 20)
+
+/* Alternative Implementation */
+void* impl_vector_auto(void* args)
+{
+  /* Get the argument struct */
+  args_t* parsed_args = (args_t*)args;
+
+  size_t llc = (parsed_args->llc_size > 0) ? parsed_args->llc_size
+                                           : VEC_AUTO_LLC_DEFAULT;
+
+  /* Two inputs and one output */
+  size_t working_set = 3 * parsed_args->size;
+
+  if (working_set > llc) {
+    return impl_vector_nt(args);
+  } else {
+    return impl_vector(args);
+  }
+}
@@ -0,0 +1,16 @@
+/* vec_auto.h
+ *
+ * Author: Khalid Al-Hawaj
+ * Date  : 16 Oct. 2026
+ *
+ * Header for the vectorized function that picks its stores by the
+ * working-set size.
+ */
+
+#ifndef __IMPL_VEC_AUTO_H_
+#define __IMPL_VEC_AUTO_H_
+
+/* Function declaration */
+void* impl_vector_auto(void* args);
+
+#endif //__IMPL_VEC_AUTO_H_
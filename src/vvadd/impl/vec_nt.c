@@ -0,0 +1,114 @@
+/* vec_nt.c
+ *
+ * Author: Khalid Al-Hawaj
+ * Date  : 16 Oct. 2026
+ *
+ * Vectorized implementation with non-temporal (streaming) stores. A
+ * regular store first reads the line it writes into the cache (read for
+ * ownership); once the working set no longer fits in the last-level
+ * cache, that read is a third of the memory traffic. Streaming stores
+ * write whole lines through the write-combining buffers instead.
+ *
+ * _mm256_stream_si256 needs a 32-byte aligned destination, so the
+ * elements before the first aligned one (the head) and the ones after
+ * the last whole vector (the tail) are added with scalar code. One more
+ * vector then brings dest to a cache-line boundary, so that the body
+ * fills a whole line in the write-combining buffers per iteration. The
+ * sources are read with unaligned loads. An sfence orders the streaming
+ * stores before the function returns.
+ */
+
+/* Standard C includes */
+#include <stdlib.h>
+#include <stdint.h>
+/*  -> SIMD header file  */
+#if defined(__amd64__) || defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__aarch__) || defined(__aarch64__) || defined(__arm64__)
+#include <arm_neon.h>
+#endif
+
+/* Include common headers */
+#include "common/macros.h"
+#include "common/types.h"
+
+/* Include application-specific headers */
+#include "include/types.h"
+#include "include/elem.h"
+
+#if defined(__amd64__) || defined(__x86_64__)
+/* Streaming kernel for elements of type T */
+#define __VEC_NT_KERNEL(sfx, T)                                             \
+static void* __impl_vector_nt_##sfx(args_t* parsed_args)                    \
+{                                                                           \
+  /* Get all the arguments */                                               \
+  register       T*     dest = (      T*)(parsed_args->output);             \
+  register const T*     src0 = (const T*)(parsed_args->input0);             \
+  register const T*     src1 = (const T*)(parsed_args->input1);             \
+  register       size_t size =            parsed_args->size / sizeof(T);    \
+                                                                            \
+  const size_t vlen = 32 / sizeof(T);                                       \
+                                                                            \
+  /* Head: up to the first 32-byte aligned element of dest */               \
+  size_t head = ((32 - ((uintptr_t)dest & 31)) & 31) / sizeof(T);           \
+  if (head > size) head = size;                                             \
+                                                                            \
+  size_t i = 0;                                                             \
+  for (; i < head; i++) {                                                   \
+    dest[i] = src0[i] + src1[i];                                            \
+  }                                                                         \
+                                                                            \
+  /* One vector up to the first 64-byte aligned element of dest */          \
+  if (((uintptr_t)(dest + i) & 63) != 0 && i + vlen <= size) {              \
+    __m256i a = _mm256_loadu_si256((const __m256i*)(src0 + i));             \
+    __m256i b = _mm256_loadu_si256((const __m256i*)(src1 + i));             \
+                                                                            \
+    _mm256_stream_si256((__m256i*)(dest + i), __vadd_##sfx(a, b));          \
+    i += vlen;                                                              \
+  }                                                                         \
+                                                                            \
+  /* Body: one aligned cache line per iteration, then at most one vector */ \
+  for (; i + 2 * vlen <= size; i += 2 * vlen) {                             \
+    __m256i a0 = _mm256_loadu_si256((const __m256i*)(src0 + i       ));     \
+    __m256i b0 = _mm256_loadu_si256((const __m256i*)(src1 + i       ));     \
+    __m256i a1 = _mm256_loadu_si256((const __m256i*)(src0 + i + vlen));     \
+    __m256i b1 = _mm256_loadu_si256((const __m256i*)(src1 + i + vlen));     \
+                                                                            \
+    _mm256_stream_si256((__m256i*)(dest + i       ), __vadd_##sfx(a0, b0)); \
+    _mm256_stream_si256((__m256i*)(dest + i + vlen), __vadd_##sfx(a1, b1)); \
+  }                                                                         \
+                                                                            \
+  for (; i + vlen <= size; i += vlen) {                                     \
+    __m256i a = _mm256_loadu_si256((const __m256i*)(src0 + i));             \
+    __m256i b = _mm256_loadu_si256((const __m256i*)(src1 + i));             \
+                                                                            \
+    _mm256_stream_si256((__m256i*)(dest + i), __vadd_##sfx(a, b));          \
+  }                                                                         \
+                                                                            \
+  /* Make the streaming stores globally visible before returning */         \
+  _mm_sfence();                                                             \
+                                                                            \
+  /* Tail */                                                                \
+  for (; i < size; i++) {                                                   \
+    dest[i] = src0[i] + src1[i];                                            \
+  }                                                                         \
+                                                                            \
+  /* Done */                                                                \
+  return NULL;                                                              \
+}
+
+ELEM_INSTANTIATE(__VEC_NT_KERNEL)
+#endif
+
+/* Alternative Implementation */
+void* impl_vector_nt(void* args)
+{
+#if defined(__amd64__) || defined(__x86_64__)
+  /* Get the argument struct */
+  args_t* parsed_args = (args_t*)args;
+
+  /* Run the kernel of the element type */
+  ELEM_DISPATCH(__impl_vector_nt, parsed_args);
+#elif defined(__aarch__) || defined(__aarch64__) || defined(__arm64__)
+#endif
+}
@@ -0,0 +1,15 @@
+/* vec_nt.h
+ *
+ * Author: Khalid Al-Hawaj
+ * Date  : 16 Oct. 2026
+ *
+ * Header for the vectorized function with non-temporal stores.
+ */
+
+#ifndef __IMPL_VEC_NT_H_
+#define __IMPL_VEC_NT_H_
+
+/* Function declaration */
+void* impl_vector_nt(void* args);
+
+#endif //__IMPL_VEC_NT_H_
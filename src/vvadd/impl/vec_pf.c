@@ -0,0 +1,107 @@
+/* vec_pf.c
+ *
+ * Author: Khalid Al-Hawaj
+ * Date  : 16 Oct. 2026
+ *
+ * Vectorized implementation with software prefetching: two vectors (one
+ * cache line) per iteration, with a _mm_prefetch of each source pf_dist
+ * bytes ahead of the loads. The hint (pf_hint) must be a compile-time
+ * constant, so the loop is instantiated once per hint, and once more
+ * with the prefetches compiled out (PF_NONE). That instantiation is the
+ * baseline of --prefetch-sweep: vec runs one vector per iteration, so it
+ * would mix the unrolling into the difference.
+ */
+
+/* Standard C includes */
+#include <stdlib.h>
+/*  -> SIMD header file  */
+#if defined(__amd64__) || defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__aarch__) || defined(__aarch64__) || defined(__arm64__)
+#include <arm_neon.h>
+#endif
+
+/* Include common headers */
+#include "common/macros.h"
+#include "common/types.h"
+
+/* Include application-specific headers */
+#include "include/types.h"
+#include "include/elem.h"
+#include "impl/vec_pf.h"
+
+#if defined(__amd64__) || defined(__x86_64__)
+/* Whole cache lines, prefetching one line of each source per iteration *
+ * if pf (a constant)                                                     */
+#define __VEC_PF_LOOP(sfx, pf, hint)                                        \
+  for (; i + 2 * vlen <= size; i += 2 * vlen) {                             \
+    if (pf) {                                                               \
+      _mm_prefetch((const char*)(src0 + i) + dist, hint);                   \
+      _mm_prefetch((const char*)(src1 + i) + dist, hint);                   \
+    }                                                                       \
+                                                                            \
+    __m256i a0 = _mm256_maskload_epi32((const int*)(src0 + i       ), vm);  \
+    __m256i b0 = _mm256_maskload_epi32((const int*)(src1 + i       ), vm);  \
+    __m256i a1 = _mm256_maskload_epi32((const int*)(src0 + i + vlen), vm);  \
+    __m256i b1 = _mm256_maskload_epi32((const int*)(src1 + i + vlen), vm);  \
+                                                                            \
+    _mm256_maskstore_epi32((int*)(dest + i       ), vm, __vadd_##sfx(a0, b0)); \
+    _mm256_maskstore_epi32((int*)(dest + i + vlen), vm, __vadd_##sfx(a1, b1)); \
+  }
+
+/* Prefetching kernel for elements of type T */
+#define __VEC_PF_KERNEL(sfx, T)                                             \
+static void* __impl_vector_pf_##sfx(args_t* parsed_args)                    \
+{                                                                           \
+  /* Get all the arguments */                                               \
+  register       T*     dest = (      T*)(parsed_args->output);             \
+  register const T*     src0 = (const T*)(parsed_args->input0);             \
+  register const T*     src1 = (const T*)(parsed_args->input1);             \
+  register       size_t size =            parsed_args->size / sizeof(T);    \
+  register       size_t dist =            parsed_args->pf_dist;             \
+                                                                            \
+  const size_t vlen = 32 / sizeof(T);                                       \
+                                                                            \
+  __m256i vm = _mm256_set1_epi32(0x80000000);                               \
+                                                                            \
+  size_t i = 0;                                                             \
+  switch (parsed_args->pf_hint) {                                           \
+    case PF_NONE: __VEC_PF_LOOP(sfx, 0, _MM_HINT_T0 ); break;               \
+    case PF_T0  : __VEC_PF_LOOP(sfx, 1, _MM_HINT_T0 ); break;               \
+    case PF_T1  : __VEC_PF_LOOP(sfx, 1, _MM_HINT_T1 ); break;               \
+    case PF_T2  : __VEC_PF_LOOP(sfx, 1, _MM_HINT_T2 ); break;               \
+    case PF_NTA :                                                           \
+    default     : __VEC_PF_LOOP(sfx, 1, _MM_HINT_NTA); break;               \
+  }                                                                         \
+                                                                            \
+  /* Remaining whole vectors, then the masked tail, as in impl_vector */    \
+  for (; i + vlen <= size; i += vlen) {                                     \
+    __m256i a = _mm256_maskload_epi32((const int*)(src0 + i), vm);          \
+    __m256i b = _mm256_maskload_epi32((const int*)(src1 + i), vm);          \
+                                                                            \
+    _mm256_maskstore_epi32((int*)(dest + i), vm, __vadd_##sfx(a, b));       \
+  }                                                                         \
+                                                                            \
+  if (i < size) {                                                           \
+    __vtail_##sfx(dest + i, src0 + i, src1 + i, size - i);                  \
+  }                                                                         \
+                                                                            \
+  /* Done */                                                                \
+  return NULL;                                                              \
+}
+
+ELEM_INSTANTIATE(__VEC_PF_KERNEL)
+#endif
+
+/* Alternative Implementation */
+void* impl_vector_pf(void* args)
+{
+#if defined(__amd64__) || defined(__x86_64__)
+  /* Get the argument struct */
+  args_t* parsed_args = (args_t*)args;
+
+  /* Run the kernel of the element type */
+  ELEM_DISPATCH(__impl_vector_pf, parsed_args);
+#elif defined(__aarch__) || defined(__aarch64__) || defined(__arm64__)
+#endif
+}
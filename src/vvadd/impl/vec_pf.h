@@ -0,0 +1,45 @@
+/* vec_pf.h
+ *
+ * Author: Khalid Al-Hawaj
+ * Date  : 16 Oct. 2026
+ *
+ * Header for the vectorized function with software prefetching.
+ */
+
+#ifndef __IMPL_VEC_PF_H_
+#define __IMPL_VEC_PF_H_
+
+/* Standard C includes */
+#include <stdbool.h>
+#include <strings.h>
+
+/* Prefetch hints, from the closest cache level to non-temporal; none *
+ * runs the same loop without prefetching                              */
+typedef enum {
+  PF_T0 = 0,
+  PF_T1,
+  PF_T2,
+  PF_NTA,
+  PF_NONE
+} pf_hint_t;
+
+static const char* const pf_hint_names[] = {
+  "t0", "t1", "t2", "nta", "none"
+};
+
+static inline bool pf_hint_parse(pf_hint_t* h, const char* str)
+{
+  for (int k = 0; k < (int)(sizeof(pf_hint_names) / sizeof(pf_hint_names[0])); k++) {
+    if (strcasecmp(str, pf_hint_names[k]) == 0) { *h = (pf_hint_t)k; return true; }
+  }
+
+  return false;
+}
+
+/* Default distance ahead of the loads, in bytes */
+#define PF_DIST_DEFAULT 512
+
+/* Function declaration */
+void* impl_vector_pf(void* args);
+
+#endif //__IMPL_VEC_PF_H_
@@ -0,0 +1,151 @@
+/* vec_unroll.c
+ *
+ * Author: Khalid Al-Hawaj
+ * Date  : 16 Oct. 2026
+ *
+ * Unrolled vectorized implementations. Unlike impl_vector, which masks
+ * every load and store although the mask only changes at the tail, the
+ * body uses plain (unmasked) loads and stores, U vectors per iteration,
+ * followed by the remaining whole vectors one at a time. The elements
+ * after the last whole vector are handled once, by one of:
+ *
+ *   mask   : a single masked load/store over the whole dwords, with the
+ *            mask taken from a sliding window over a constant table;
+ *            8- and 16-bit elements finish with scalar code
+ *   scalar : a scalar loop
+ *   overlap: one unmasked vector ending at the last element; it rewrites
+ *            some elements with the same values, so it needs at least
+ *            one whole vector (smaller inputs fall back to the mask)
+ *
+ * The loads and stores are the unaligned forms, which run at full speed
+ * on aligned data; see --align for what misalignment costs.
+ */
+
+/* Standard C includes */
+#include <stdlib.h>
+#include <stdint.h>
+/*  -> SIMD header file  */
+#if defined(__amd64__) || defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__aarch__) || defined(__aarch64__) || defined(__arm64__)
+#include <arm_neon.h>
+#endif
+
+/* Include common headers */
+#include "common/macros.h"
+#include "common/types.h"
+
+/* Include application-specific headers */
+#include "include/types.h"
+#include "include/elem.h"
+#include "impl/vec_unroll.h"
+
+#if defined(__amd64__) || defined(__x86_64__)
+/* One vector at element j */
+#define __VEC_ONE(sfx, j)                                                   \
+  _mm256_storeu_si256((__m256i*)(dest + (j)),                               \
+    __vadd_##sfx(_mm256_loadu_si256((const __m256i*)(src0 + (j))),          \
+                 _mm256_loadu_si256((const __m256i*)(src1 + (j)))))
+
+/* Tails: the elements [i, size), fewer than one vector */
+#define __VEC_TAIL_MASK(sfx)                                                \
+  if (i < size) {                                                           \
+    __vtail_##sfx(dest + i, src0 + i, src1 + i, size - i);                  \
+  }
+
+#define __VEC_TAIL_SCALAR(sfx)                                              \
+  for (; i < size; i++) {                                                   \
+    dest[i] = src0[i] + src1[i];                                            \
+  }
+
+#define __VEC_TAIL_OVERLAP(sfx)                                             \
+  if (i < size) {                                                           \
+    if (size >= vlen) {                                                     \
+      __VEC_ONE(sfx, size - vlen);                                          \
+    } else {                                                                \
+      __vtail_##sfx(dest + i, src0 + i, src1 + i, size - i);                \
+    }                                                                       \
+  }
+
+/* A kernel for elements of type T with U vectors per iteration and the *
+ * given tail                                                            */
+#define __VEC_UNROLL_KERNEL(name, sfx, T, U, TAIL)                          \
+static void* __##name##_##sfx(args_t* parsed_args)                          \
+{                                                                           \
+  /* Get all the arguments */                                               \
+  register       T*     dest = (      T*)(parsed_args->output);             \
+  register const T*     src0 = (const T*)(parsed_args->input0);             \
+  register const T*     src1 = (const T*)(parsed_args->input1);             \
+  register       size_t size =            parsed_args->size / sizeof(T);    \
+                                                                            \
+  const size_t vlen = 32 / sizeof(T);                                       \
+                                                                            \
+  size_t i = 0;                                                             \
+                                                                            \
+  /* Unrolled body */                                                       \
+  for (; i + (U) * vlen <= size; i += (U) * vlen) {                         \
+    for (int u = 0; u < (U); u++) {                                         \
+      __VEC_ONE(sfx, i + u * vlen);                                         \
+    }                                                                       \
+  }                                                                         \
+                                                                            \
+  /* Remaining whole vectors */                                             \
+  for (; i + vlen <= size; i += vlen) {                                     \
+    __VEC_ONE(sfx, i);                                                      \
+  }                                                                         \
+                                                                            \
+  /* Tail */                                                                \
+  TAIL(sfx)                                                                 \
+                                                                            \
+  /* Done */                                                                \
+  return NULL;                                                              \
+}
+
+#define __U2_MASK(sfx, T)    __VEC_UNROLL_KERNEL(impl_vector_u2_mask   , sfx, T, 2, __VEC_TAIL_MASK   )
+#define __U2_SCALAR(sfx, T)  __VEC_UNROLL_KERNEL(impl_vector_u2_scalar , sfx, T, 2, __VEC_TAIL_SCALAR )
+#define __U2_OVERLAP(sfx, T) __VEC_UNROLL_KERNEL(impl_vector_u2_overlap, sfx, T, 2, __VEC_TAIL_OVERLAP)
+#define __U4_MASK(sfx, T)    __VEC_UNROLL_KERNEL(impl_vector_u4_mask   , sfx, T, 4, __VEC_TAIL_MASK   )
+#define __U4_SCALAR(sfx, T)  __VEC_UNROLL_KERNEL(impl_vector_u4_scalar , sfx, T, 4, __VEC_TAIL_SCALAR )
+#define __U4_OVERLAP(sfx, T) __VEC_UNROLL_KERNEL(impl_vector_u4_overlap, sfx, T, 4, __VEC_TAIL_OVERLAP)
+#define __U8_MASK(sfx, T)    __VEC_UNROLL_KERNEL(impl_vector_u8_mask   , sfx, T, 8, __VEC_TAIL_MASK   )
+#define __U8_SCALAR(sfx, T)  __VEC_UNROLL_KERNEL(impl_vector_u8_scalar , sfx, T, 8, __VEC_TAIL_SCALAR )
+#define __U8_OVERLAP(sfx, T) __VEC_UNROLL_KERNEL(impl_vector_u8_overlap, sfx, T, 8, __VEC_TAIL_OVERLAP)
+
+ELEM_INSTANTIATE(__U2_MASK   )
+ELEM_INSTANTIATE(__U2_SCALAR )
+ELEM_INSTANTIATE(__U2_OVERLAP)
+ELEM_INSTANTIATE(__U4_MASK   )
+ELEM_INSTANTIATE(__U4_SCALAR )
+ELEM_INSTANTIATE(__U4_OVERLAP)
+ELEM_INSTANTIATE(__U8_MASK   )
+ELEM_INSTANTIATE(__U8_SCALAR )
+ELEM_INSTANTIATE(__U8_OVERLAP)
+
+/* An implementation: the kernel of the element type */
+#define __VEC_UNROLL_IMPL(name)                                             \
+void* name(void* args)                                                      \
+{                                                                           \
+  /* Get the argument struct */                                             \
+  args_t* parsed_args = (args_t*)args;                                      \
+                                                                            \
+  /* Run the kernel of the element type */                                  \
+  ELEM_DISPATCH(__##name, parsed_args);                                     \
+}
+#else
+#define __VEC_UNROLL_IMPL(name)                                             \
+void* name(void* args)                                                      \
+{                                                                           \
+  return NULL;                                                              \
+}
+#endif
+
+/* Alternative Implementations */
+__VEC_UNROLL_IMPL(impl_vector_u2_mask   )
+__VEC_UNROLL_IMPL(impl_vector_u2_scalar )
+__VEC_UNROLL_IMPL(impl_vector_u2_overlap)
+__VEC_UNROLL_IMPL(impl_vector_u4_mask   )
+__VEC_UNROLL_IMPL(impl_vector_u4_scalar )
+__VEC_UNROLL_IMPL(impl_vector_u4_overlap)
+__VEC_UNROLL_IMPL(impl_vector_u8_mask   )
+__VEC_UNROLL_IMPL(impl_vector_u8_scalar )
+__VEC_UNROLL_IMPL(impl_vector_u8_overlap)
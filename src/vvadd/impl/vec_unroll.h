@@ -0,0 +1,24 @@
+/* vec_unroll.h
+ *
+ * Author: Khalid Al-Hawaj
+ * Date  : 16 Oct. 2026
+ *
+ * Header for the unrolled vectorized functions; one per unroll factor
+ * (2x, 4x, 8x) and tail strategy (masked, scalar, overlapping).
+ */
+
+#ifndef __IMPL_VEC_UNROLL_H_
+#define __IMPL_VEC_UNROLL_H_
+
+/* Function declarations */
+void* impl_vector_u2_mask   (void* args);
+void* impl_vector_u2_scalar (void* args);
+void* impl_vector_u2_overlap(void* args);
+void* impl_vector_u4_mask   (void* args);
+void* impl_vector_u4_scalar (void* args);
+void* impl_vector_u4_overlap(void* args);
+void* impl_vector_u8_mask   (void* args);
+void* impl_vector_u8_scalar (void* args);
+void* impl_vector_u8_overlap(void* args);
+
+#endif //__IMPL_VEC_UNROLL_H_
@@ -0,0 +1,173 @@
+/* elem.h
+ *
+ * Author: Khalid Al-Hawaj
+ * Date  : 16 Oct. 2026
+ *
+ * This file contains the element types of vvadd (--type). Every
+ * implementation is written once, as a kernel macro KERNEL(sfx, T), and
+ * ELEM_INSTANTIATE() stamps it out for each type, as <prefix>_<sfx>.
+ * The implementation itself then only calls ELEM_DISPATCH(), which picks
+ * the instance for args->type.
+ *
+ * The vectorized kernels work on __m256i and add with __vadd_<sfx>();
+ * the real types are reinterpreted as __m256 / __m256d for the add only.
+ * Masked loads and stores only exist for 32- and 64-bit lanes, so a
+ * masked tail covers whole dwords and leaves the last (up to three)
+ * bytes of 8- and 16-bit elements to scalar code.
+*/
+
+#ifndef __INCLUDE_ELEM_H_
+#define __INCLUDE_ELEM_H_
+
+/* Standard C includes */
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <strings.h>
+#include <math.h>
+/*  -> SIMD header file  */
+#if defined(__amd64__) || defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+/* Element types */
+typedef enum {
+  ELEM_I8 = 0,
+  ELEM_I16,
+  ELEM_I32,
+  ELEM_I64,
+  ELEM_F32,
+  ELEM_F64
+} elem_t;
+
+static const char* const elem_names[] = {
+  "i8", "i16", "i32", "i64", "f32", "f64"
+};
+
+static const size_t elem_sizes[] = {
+  1, 2, 4, 8, 4, 8
+};
+
+static inline bool elem_parse(elem_t* t, const char* str)
+{
+  for (int k = 0; k < (int)(sizeof(elem_names) / sizeof(elem_names[0])); k++) {
+    if (strcasecmp(str, elem_names[k]) == 0) { *t = (elem_t)k; return true; }
+  }
+
+  return false;
+}
+
+static inline bool elem_is_real(elem_t t)
+{
+  return (t == ELEM_F32) || (t == ELEM_F64);
+}
+
+/* Stamp out KERNEL(sfx, T) for every element type */
+#define ELEM_INSTANTIATE(KERNEL) \
+  KERNEL(i8 , int8_t )           \
+  KERNEL(i16, int16_t)           \
+  KERNEL(i32, int32_t)           \
+  KERNEL(i64, int64_t)           \
+  KERNEL(f32, float  )           \
+  KERNEL(f64, double )
+
+/* Return the result of <prefix>_<sfx>(p_args) for p_args->type */
+#define ELEM_DISPATCH(prefix, p_args)                   \
+  switch ((elem_t)((p_args)->type)) {                   \
+    case ELEM_I8 : return prefix##_i8 (p_args);         \
+    case ELEM_I16: return prefix##_i16(p_args);         \
+    case ELEM_I64: return prefix##_i64(p_args);         \
+    case ELEM_F32: return prefix##_f32(p_args);         \
+    case ELEM_F64: return prefix##_f64(p_args);         \
+    case ELEM_I32:                                      \
+    default      : return prefix##_i32(p_args);         \
+  }
+
+/* Compare the outputs: bitwise for the integers, and within a relative *
+ * tolerance for the reals (one add rounds the same in every kernel, so *
+ * the tolerance only guards against contraction or reassociation).    */
+static inline bool elem_check(elem_t t, const void* ref, const void* out,
+                              size_t nbytes)
+{
+  switch (t) {
+    case ELEM_F32: {
+      const float* r = (const float*)ref;
+      const float* o = (const float*)out;
+      for (size_t i = 0; i < nbytes / sizeof(float); i++) {
+        if (!(fabsf(r[i] - o[i]) <= 1e-6f * fabsf(r[i]))) return false;
+      }
+      return true;
+    }
+
+    case ELEM_F64: {
+      const double* r = (const double*)ref;
+      const double* o = (const double*)out;
+      for (size_t i = 0; i < nbytes / sizeof(double); i++) {
+        if (!(fabs(r[i] - o[i]) <= 1e-15 * fabs(r[i]))) return false;
+      }
+      return true;
+    }
+
+    default: {
+      const uint8_t* r = (const uint8_t*)ref;
+      const uint8_t* o = (const uint8_t*)out;
+      for (size_t i = 0; i < nbytes; i++) {
+        if (r[i] != o[i]) return false;
+      }
+      return true;
+    }
+  }
+}
+
+#if defined(__amd64__) || defined(__x86_64__)
+/* Lane-wise additions */
+static inline __m256i __vadd_i8 (__m256i a, __m256i b) { return _mm256_add_epi8 (a, b); }
+static inline __m256i __vadd_i16(__m256i a, __m256i b) { return _mm256_add_epi16(a, b); }
+static inline __m256i __vadd_i32(__m256i a, __m256i b) { return _mm256_add_epi32(a, b); }
+static inline __m256i __vadd_i64(__m256i a, __m256i b) { return _mm256_add_epi64(a, b); }
+
+static inline __m256i __vadd_f32(__m256i a, __m256i b)
+{
+  return _mm256_castps_si256(_mm256_add_ps(_mm256_castsi256_ps(a),
+                                           _mm256_castsi256_ps(b)));
+}
+
+static inline __m256i __vadd_f64(__m256i a, __m256i b)
+{
+  return _mm256_castpd_si256(_mm256_add_pd(_mm256_castsi256_pd(a),
+                                           _mm256_castsi256_pd(b)));
+}
+
+/* Sliding window: the mask of the first n dwords starts at 8 - n */
+static const int32_t __elem_mask_window[16] = {
+  -1, -1, -1, -1, -1, -1, -1, -1,
+   0,  0,  0,  0,  0,  0,  0,  0
+};
+
+static inline __m256i elem_mask32(size_t ndwords)
+{
+  return _mm256_loadu_si256((const __m256i*)(__elem_mask_window + 8 - ndwords));
+}
+
+/* Masked tail of n < 32 / sizeof(T) elements: one masked vector over *
+ * the whole dwords, then scalar code for the rest.                    */
+#define __ELEM_TAIL(sfx, T)                                                 \
+static inline void __vtail_##sfx(T* dest, const T* src0, const T* src1,     \
+                                 size_t n)                                  \
+{                                                                           \
+  size_t  ndw = (n * sizeof(T)) / 4;                                        \
+  __m256i vm  = elem_mask32(ndw);                                           \
+                                                                            \
+  _mm256_maskstore_epi32((int*)dest, vm,                                    \
+    __vadd_##sfx(_mm256_maskload_epi32((const int*)src0, vm),               \
+                 _mm256_maskload_epi32((const int*)src1, vm)));             \
+                                                                            \
+  for (size_t j = (ndw * 4) / sizeof(T); j < n; j++) {                      \
+    dest[j] = src0[j] + src1[j];                                            \
+  }                                                                         \
+}
+
+ELEM_INSTANTIATE(__ELEM_TAIL)
+#endif
+
+#endif //__INCLUDE_ELEM_H_
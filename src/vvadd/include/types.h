@@ -16,8 +16,31 @@ typedef struct {
 
   size_t size;
 
+  /* Element type (elem_t in include/elem.h); size is in bytes */
+  int     type;
+
   int     cpu;
   int     nthreads;
+
+  /* Worker i is pinned to cpus[i] (--placement), or NULL */
+  const int* cpus;
+
+  /* Per-worker compute time in ns, accumulated over invocations; *
+   * one slot per thread, or NULL when not recorded.               */
+  uint64_t* worker_ns;
+
+  /* Size of the last-level cache in bytes (common/topo.h), or 0 if *
+   * unknown; vec-auto streams the stores of larger working sets.    */
+  size_t llc_size;
+
+  /* Software prefetching of vec-pf: distance ahead of the loads in *
+   * bytes, and hint (pf_hint_t in impl/vec_pf.h).                   */
+  size_t pf_dist;
+  int    pf_hint;
+
+  /* Persistent worker pool (common/pool.h), or NULL to spawn the *
+   * threads on every invocation.                                  */
+  struct pool* pool;
 } args_t;
 
 #endif //__INCLUDE_TYPES_H_
@@ -17,9 +17,12 @@
  * record the runtime of _each_ invocation through the following Linux
  * API:
  *    clock_gettime(), with the clk_id set to CLOCK_MONOTONIC
- * Then, the file will calculate the standard deviation and calculate
- * an outlier-free average by excluding runtimes that are larger than
- * 2 standard deviation of the original average.
+ * or, with "--timer tsc", the serialized time-stamp counter (see
+ * common/timer.h).
+ * Then, the file will report robust statistics (min, median and its
+ * bootstrap confidence interval, tail percentiles and MAD) alongside
+ * an outlier-free average that excludes runtimes more than nstdevs
+ * standard deviations away from the average (see common/stats.h).
  */
 
 /* Set features         */
@@ -47,17 +50,91 @@
 #include "impl/naive.h"
 #include "impl/opt.h"
 #include "impl/vec.h"
+#include "impl/vec_nt.h"
+#include "impl/vec_auto.h"
+#include "impl/vec_pf.h"
+#include "impl/vec_unroll.h"
 #include "impl/para.h"
 
 /* Include common headers */
 #include "common/types.h"
 #include "common/macros.h"
+#include "common/perf.h"
+#include "common/timer.h"
+#include "common/stats.h"
+#include "common/impl.h"
+#include "common/arena.h"
+#include "common/align.h"
+#include "common/faults.h"
+#include "common/topo.h"
+#include "common/numa.h"
+#include "common/rng.h"
+#include "common/pool.h"
+#include "common/bench.h"
 
 /* Include application-specific headers */
 #include "include/types.h"
+#include "include/elem.h"
 
 const int SIZE_DATA = 4 * 1024 * 1024;
 
+/* Output of the measured runs, for the callbacks of common/bench.h */
+typedef struct {
+  const args_t* args;
+  const byte*   ref;
+} output_t;
+
+/* Clear the output of args and set its guard */
+static void output_reset(void* ctx)
+{
+  const args_t* args = ((output_t*)ctx)->args;
+
+  memset(args->output, 0, args->size);
+  __SET_GUARD(args->output, args->size);
+}
+
+/* The output of args matches the reference and its guard is intact */
+static bool output_check(void* ctx)
+{
+  const output_t* o    = (output_t*)ctx;
+  const args_t*   args = o->args;
+
+  return elem_check((elem_t)args->type, o->ref, args->output, args->size) &&
+         __CHECK_GUARD(args->output, args->size);
+}
+
+/* Thread count and per-worker compute times of args */
+static void threads_set(void* args, int nthreads, uint64_t* worker_ns)
+{
+  ((args_t*)args)->nthreads  = nthreads;
+  ((args_t*)args)->worker_ns = worker_ns;
+}
+
+/* Buffers of the offset sweep */
+static const char* const buffer_names[3] = { "src0", "src1", "dest" };
+
+typedef struct {
+  args_t* args;
+  byte*   bufs[3];  /* allocations of src0, src1 and dest */
+  size_t  cur [3];  /* their current offsets              */
+  size_t  size;
+} buffers_t;
+
+/* Point src0, src1 and dest of args at their new offsets; the inputs *
+ * slide their data along, dest is rewritten by every run anyway.      */
+static void buffers_place(void* ctx, const size_t* offs)
+{
+  buffers_t* p = (buffers_t*)ctx;
+
+  p->args->input0 = align_move(align_base(p->bufs[0]), p->cur[0], offs[0], p->size);
+  p->args->input1 = align_move(align_base(p->bufs[1]), p->cur[1], offs[1], p->size);
+  p->args->output = align_base(p->bufs[2]) + offs[2];
+
+  for (int b = 0; b < 3; b++) {
+    p->cur[b] = offs[b];
+  }
+}
+
 int main(int argc, char** argv)
 {
   /* Set the buffer for printf to NULL */
@@ -67,38 +144,99 @@ int main(int argc, char** argv)
   int nthreads = 1;
   int cpu      = 0;
 
+  place_t     placement = PLACE_COMPACT;
+  numa_mode_t numa      = NUMA_NONE;
+  pages_t     pages     = PAGES_4K;
+
+  int threads_min = 0;
+  int threads_max = 0;
+
+  bool spawn    = false;
+  bool prefault = false;
+
   int nruns    = 10000;
   int nstdevs  = 3;
 
+  int nreps         = 0;
+  int min_sample_us = 50;
+  int warmup_ms     = 500;
+
   /* Data */
-  int data_size = SIZE_DATA;
+  size_t   nelems = SIZE_DATA / sizeof(int);
+  elem_t   type   = ELEM_I32;
+  uint32_t seed   = RNG_SEED;
+
+  /* Working-set sweep (in elements) */
+  size_t sweep_min    = 0;
+  size_t sweep_max    = 0;
+  double sweep_factor = 0.0;
+
+  /* Byte offsets of src0, src1 and dest from a 4 KiB boundary */
+  size_t align[3] = { 0, 0, 0 };
+
+  /* Offset sweep; every buffer takes each of the offsets */
+  size_t offs[ALIGN_MAX_OFFS];
+  int    noffs = 0;
+
+  /* Software prefetching of vec-pf, and its sweep over distances */
+  size_t    pf_dist = PF_DIST_DEFAULT;
+  pf_hint_t pf_hint = PF_T0;
+
+  size_t pf_dists[ALIGN_MAX_OFFS];
+  int    npf_dists = 0;
 
   /* Parse arguments */
-  /* Function pointers */
-  void* (*impl_scalar_naive_ptr)(void* args) = impl_scalar_naive;
-  void* (*impl_scalar_opt_ptr  )(void* args) = impl_scalar_opt;
-  void* (*impl_vector_ptr      )(void* args) = impl_vector;
-  void* (*impl_parallel_ptr    )(void* args) = impl_parallel;
+  /* Implementations */
+  const impl_t impls[] = {
+    { "naive"   , "scalar_naive"   , impl_scalar_naive },
+    { "opt"     , "scalar_opt"     , impl_scalar_opt   },
+    { "vec"     , "vectorized"     , impl_vector       },
+    { "vec-nt"  , "vectorized_nt"  , impl_vector_nt    },
+    { "vec-auto", "vectorized_auto", impl_vector_auto  },
+    { "vec-pf"  , "vectorized_pf"  , impl_vector_pf    },
+
+    { "vec-u2-mask"   , "vectorized_u2_mask"   , impl_vector_u2_mask    },
+    { "vec-u2-scalar" , "vectorized_u2_scalar" , impl_vector_u2_scalar  },
+    { "vec-u2-overlap", "vectorized_u2_overlap", impl_vector_u2_overlap },
+    { "vec-u4-mask"   , "vectorized_u4_mask"   , impl_vector_u4_mask    },
+    { "vec-u4-scalar" , "vectorized_u4_scalar" , impl_vector_u4_scalar  },
+    { "vec-u4-overlap", "vectorized_u4_overlap", impl_vector_u4_overlap },
+    { "vec-u8-mask"   , "vectorized_u8_mask"   , impl_vector_u8_mask    },
+    { "vec-u8-scalar" , "vectorized_u8_scalar" , impl_vector_u8_scalar  },
+    { "vec-u8-overlap", "vectorized_u8_overlap", impl_vector_u8_overlap },
+    { "para"    , "parallelized"   , impl_parallel     },
+  };
+  const int nimpls = sizeof(impls) / sizeof(impl_t);
 
   /* Chosen */
-  void* (*impl)(void* args) = NULL;
-  const char* impl_str      = NULL;
+  int  sel[IMPL_MAX];
+  int  nsel = 0;
+
+  /* Interleaved A/B comparison */
+  int  ab_sel[IMPL_MAX];
+  int  nab  = 0;
+
+  bool parse_args_err       = false;
+
+  /* Performance counters */
+  perf_group_t perf;
+  perf_init(&perf);
+
+  /* Timer */
+  timer_cfg_t timer;
+  timer_init(&timer);
 
   bool help = false;
   for (int i = 1; i < argc; i++) {
     /* Implementations */
     if (strcmp(argv[i], "-i") == 0 || strcmp(argv[i], "--impl") == 0) {
       assert (++i < argc);
-      if (strcmp(argv[i], "naive") == 0) {
-        impl = impl_scalar_naive_ptr; impl_str = "scalar_naive";
-      } else if (strcmp(argv[i], "opt"  ) == 0) {
-        impl = impl_scalar_opt_ptr  ; impl_str = "scalar_opt"  ;
-      } else if (strcmp(argv[i], "vec"  ) == 0) {
-        impl = impl_vector_ptr      ; impl_str = "vectorized"  ;
-      } else if (strcmp(argv[i], "para" ) == 0) {
-        impl = impl_parallel_ptr    ; impl_str = "parallelized";
-      } else {
-        impl = NULL                 ; impl_str = "unknown"     ;
+      char bad[64];
+      if (!impl_parse(impls, nimpls, argv[i], sel, &nsel, bad, sizeof(bad))) {
+        printf("\n");
+        printf("ERROR: Unknown \"%s\" implementation.\n", bad);
+
+        parse_args_err = true;
       }
 
       continue;
@@ -107,7 +245,129 @@ int main(int argc, char** argv)
     /* Input/output data size */
     if (strcmp(argv[i], "-s") == 0 || strcmp(argv[i], "--size") == 0) {
       assert (++i < argc);
-      data_size = atoi(argv[i]) * sizeof(int);
+      char* end;
+      unsigned long long n = strtoull(argv[i], &end, 0);
+      if (*end != '\0' || n == 0 ||
+          n > (SIZE_MAX - 64) / sizeof(int64_t)) {
+        printf("\n");
+        printf("ERROR: Invalid size \"%s\" (must be > 0 and fit in memory)\n", argv[i]);
+
+        parse_args_err = true;
+      } else {
+        nelems = n;
+      }
+
+      continue;
+    }
+
+    if (strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--type") == 0) {
+      assert (++i < argc);
+      if (!elem_parse(&type, argv[i])) {
+        printf("\n");
+        printf("ERROR: Unknown element type \"%s\"\n", argv[i]);
+
+        parse_args_err = true;
+      }
+
+      continue;
+    }
+
+    if (strcmp(argv[i], "--sweep") == 0) {
+      assert (++i < argc);
+      if (sscanf(argv[i], "%zu:%zu:%lf", &sweep_min, &sweep_max, &sweep_factor) != 3 ||
+          sweep_min == 0 || sweep_max < sweep_min || sweep_factor <= 1.0 ||
+          sweep_max > (SIZE_MAX - 64) / sizeof(int64_t)) {
+        printf("\n");
+        printf("ERROR: Invalid sweep \"%s\" (expected min:max:factor, factor > 1)\n", argv[i]);
+
+        sweep_min      = 0;
+        parse_args_err = true;
+      }
+
+      continue;
+    }
+
+    if (strcmp(argv[i], "--align") == 0) {
+      assert (++i < argc);
+      int n;
+      if (!align_parse(argv[i], 1, align, 3, &n) || n == 2) {
+        printf("\n");
+        printf("ERROR: Invalid offsets \"%s\" (expected 1 or 3 offsets below %d)\n",
+                                                               argv[i], ALIGN_PAGE);
+
+        parse_args_err = true;
+      } else if (n == 1) {
+        align[1] = align[0];
+        align[2] = align[0];
+      }
+
+      continue;
+    }
+
+    if (strcmp(argv[i], "--offset-sweep") == 0) {
+      assert (++i < argc);
+      if (!align_parse(argv[i], 1, offs, ALIGN_MAX_OFFS, &noffs)) {
+        printf("\n");
+        printf("ERROR: Invalid offset sweep \"%s\" (expected offsets below %d)\n",
+                                                               argv[i], ALIGN_PAGE);
+
+        noffs          = 0;
+        parse_args_err = true;
+      }
+
+      continue;
+    }
+
+    if (strcmp(argv[i], "--prefetch-dist") == 0) {
+      assert (++i < argc);
+      char* end;
+      pf_dist = strtoull(argv[i], &end, 0);
+      if (*end != '\0') {
+        printf("\n");
+        printf("ERROR: Invalid prefetch distance \"%s\"\n", argv[i]);
+
+        parse_args_err = true;
+      }
+
+      continue;
+    }
+
+    if (strcmp(argv[i], "--prefetch-hint") == 0) {
+      assert (++i < argc);
+      if (!pf_hint_parse(&pf_hint, argv[i])) {
+        printf("\n");
+        printf("ERROR: Unknown prefetch hint \"%s\"\n", argv[i]);
+
+        parse_args_err = true;
+      }
+
+      continue;
+    }
+
+    if (strcmp(argv[i], "--prefetch-sweep") == 0) {
+      assert (++i < argc);
+      char* str = argv[i];
+      npf_dists = 0;
+      while (*str != '\0' && npf_dists < ALIGN_MAX_OFFS) {
+        char* end;
+        pf_dists[npf_dists++] = strtoull(str, &end, 0);
+        if (end == str || (*end != ',' && *end != '\0')) break;
+        str = (*end == ',') ? (end + 1) : end;
+      }
+      if (*str != '\0' || npf_dists == 0) {
+        printf("\n");
+        printf("ERROR: Invalid prefetch sweep \"%s\" (expected distances in bytes)\n", argv[i]);
+
+        npf_dists      = 0;
+        parse_args_err = true;
+      }
+
+      continue;
+    }
+
+    if (strcmp(argv[i], "--seed") == 0) {
+      assert (++i < argc);
+      seed = (uint32_t)strtoul(argv[i], NULL, 0);
 
       continue;
     }
@@ -127,6 +387,73 @@ int main(int argc, char** argv)
       continue;
     }
 
+    if (strcmp(argv[i], "--reps") == 0) {
+      assert (++i < argc);
+      nreps = atoi(argv[i]);
+
+      continue;
+    }
+
+    if (strcmp(argv[i], "--min-sample-us") == 0) {
+      assert (++i < argc);
+      min_sample_us = atoi(argv[i]);
+
+      continue;
+    }
+
+    if (strcmp(argv[i], "--warmup-ms") == 0) {
+      assert (++i < argc);
+      warmup_ms = atoi(argv[i]);
+
+      continue;
+    }
+
+    /* Interleaved A/B comparison */
+    if (strcmp(argv[i], "--ab") == 0) {
+      assert (++i < argc);
+      char bad[64];
+      if (!impl_parse(impls, nimpls, argv[i], ab_sel, &nab, bad, sizeof(bad))) {
+        printf("\n");
+        printf("ERROR: Unknown \"%s\" implementation.\n", bad);
+
+        parse_args_err = true;
+      } else if (nab < 2) {
+        printf("\n");
+        printf("ERROR: --ab needs at least two implementations.\n");
+
+        parse_args_err = true;
+      }
+
+      continue;
+    }
+
+    /* Timer source */
+    if (strcmp(argv[i], "--timer") == 0) {
+      assert (++i < argc);
+      if (!timer_parse(&timer, argv[i])) {
+        printf("\n");
+        printf("ERROR: Unknown timer \"%s\"\n", argv[i]);
+
+        parse_args_err = true;
+      }
+
+      continue;
+    }
+
+    /* Performance counters */
+    if (strcmp(argv[i], "--counters") == 0) {
+      assert (++i < argc);
+      char bad[64];
+      if (!perf_parse(&perf, argv[i], bad, sizeof(bad))) {
+        printf("\n");
+        printf("ERROR: Unknown performance counter \"%s\"\n", bad);
+
+        parse_args_err = true;
+      }
+
+      continue;
+    }
+
     /* Parallelization */
     if (strcmp(argv[i], "-n") == 0 || strcmp(argv[i], "--nthreads") == 0) {
       assert (++i < argc);
@@ -135,6 +462,72 @@ int main(int argc, char** argv)
       continue;
     }
 
+    if (strcmp(argv[i], "--threads-sweep") == 0) {
+      assert (++i < argc);
+      int n = sscanf(argv[i], "%d:%d", &threads_min, &threads_max);
+      if (n == 1) {
+        threads_max = threads_min;
+        threads_min = 1;
+      }
+      if (n < 1 || threads_min < 1 || threads_max < threads_min) {
+        printf("\n");
+        printf("ERROR: Invalid thread sweep \"%s\" (expected min:max)\n", argv[i]);
+
+        threads_max    = 0;
+        parse_args_err = true;
+      }
+
+      continue;
+    }
+
+    if (strcmp(argv[i], "--prefault") == 0) {
+      prefault = true;
+
+      continue;
+    }
+
+    if (strcmp(argv[i], "--spawn") == 0) {
+      spawn = true;
+
+      continue;
+    }
+
+    if (strcmp(argv[i], "--pages") == 0) {
+      assert (++i < argc);
+      if (!pages_parse(&pages, argv[i])) {
+        printf("\n");
+        printf("ERROR: Unknown page size \"%s\"\n", argv[i]);
+
+        parse_args_err = true;
+      }
+
+      continue;
+    }
+
+    if (strcmp(argv[i], "--numa") == 0) {
+      assert (++i < argc);
+      if (!numa_parse(&numa, argv[i])) {
+        printf("\n");
+        printf("ERROR: Unknown NUMA mode \"%s\"\n", argv[i]);
+
+        parse_args_err = true;
+      }
+
+      continue;
+    }
+
+    if (strcmp(argv[i], "--placement") == 0) {
+      assert (++i < argc);
+      if (!place_parse(&placement, argv[i])) {
+        printf("\n");
+        printf("ERROR: Unknown placement \"%s\"\n", argv[i]);
+
+        parse_args_err = true;
+      }
+
+      continue;
+    }
+
     if (strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "--cpu") == 0) {
       assert (++i < argc);
       cpu = atoi(argv[i]);
@@ -150,35 +543,131 @@ int main(int argc, char** argv)
     }
   }
 
-  if (help || impl == NULL) {
-    if (!help) {
-      if (impl_str != NULL) {
-        printf("\n");
-        printf("ERROR: Unknown \"%s\" implementation.\n", impl_str);
-      } else {
-        printf("\n");
-        printf("ERROR: No implementation was chosen.\n");
-      }
-    }
+  /* Sizes in bytes of the chosen element type */
+  size_t esz       = elem_sizes[type];
+  size_t data_size = nelems * esz;
+
+  /* Offsets must keep the elements naturally aligned */
+  bool offs_aligned = true;
+  for (int b = 0; b < 3;     b++) offs_aligned = offs_aligned && (align[b] % esz == 0);
+  for (int o = 0; o < noffs; o++) offs_aligned = offs_aligned && (offs [o] % esz == 0);
+  if (!offs_aligned) {
+    printf("\n");
+    printf("ERROR: Offsets must be multiples of the element size (%zu for %s)\n",
+                                                           esz, elem_names[type]);
+
+    parse_args_err = true;
+  }
+
+  /* The modes are not combined; only --ab runs after any of them */
+  int nmodes = (sweep_min > 0) + (noffs > 0) + (npf_dists > 0) + (threads_max > 0);
+  if (!parse_args_err && !help && nmodes > 1) {
+    printf("\n");
+    printf("ERROR: --sweep, --offset-sweep, --prefetch-sweep and --threads-sweep\n");
+    printf("       cannot be combined; choose one.\n");
+
+    parse_args_err = true;
+  }
+
+  if (!parse_args_err && !help && nsel > 0 && (threads_max > 0 || npf_dists > 0)) {
+    printf("\n");
+    printf("ERROR: --%s runs its own implementation; -i does not apply.\n",
+                          (threads_max > 0) ? "threads-sweep" : "prefetch-sweep");
+
+    parse_args_err = true;
+  }
+
+  if (!parse_args_err && !help && nsel == 0 && (sweep_min > 0 || noffs > 0)) {
+    printf("\n");
+    printf("ERROR: --%s needs the implementations to sweep (-i).\n",
+                                     (sweep_min > 0) ? "sweep" : "offset-sweep");
+
+    parse_args_err = true;
+  }
+
+  if (!parse_args_err && !help && nsel == 0 && nab == 0 && threads_max == 0 &&
+      npf_dists == 0) {
+    printf("\n");
+    printf("ERROR: No implementation was chosen.\n");
+  }
+
+  if (help || (nsel == 0 && nab == 0 && threads_max == 0 && npf_dists == 0) ||
+      parse_args_err) {
     printf("\n");
     printf("Usage:\n");
-    printf("  %s {-i | --impl} impl_str [Options]\n", argv[0]);
+    printf("  %s {-i | --impl} impl_str[,impl_str...] [Options]\n", argv[0]);
     printf("  \n");
     printf("  Required:\n");
-    printf("    -i | --impl      Available implementations = {naive, opt, vec, para}\n");
+    printf("    -i | --impl      Available implementations = {");
+    impl_print_names(impls, nimpls);
+    printf("}\n");
+    printf("                     A comma-separated list or \"all\" runs several in one process.\n");
+    printf("                     (not required with --ab, --threads-sweep or --prefetch-sweep)\n");
     printf("    \n");
     printf("  Options:\n");
     printf("    -h | --help      Print this message\n");
     printf("    -n | --nthreads  Set number of threads available (default = %d)\n", nthreads);
+    printf("         --threads-sweep  Run the parallel implementation at each thread count in\n");
+    printf("                     min:max and report scaling and worker imbalance (e.g. 1:16)\n");
+    printf("         --spawn     Create the worker threads on every invocation instead of\n");
+    printf("                     dispatching to a persistent pool started once at startup\n");
     printf("    -c | --cpu       Set the main CPU for the program (default = %d)\n", cpu);
-    printf("    -s | --size      Size of input and output data (default = %ld)\n", data_size / sizeof(int));
+    printf("         --placement  Placement of the worker threads on the CPUs (default = %s)\n", place_names[placement]);
+    printf("                     Available placements = {compact, scatter, nosmt, numa-spread}.\n");
+    printf("         --numa      Page placement of the inputs and output (default = %s)\n", numa_names[numa]);
+    printf("                     Available modes = {none, firsttouch, interleave, local}.\n");
+    printf("         --pages     Pages backing the data; falls back to smaller pages (default = %s)\n", pages_names[pages]);
+    printf("                     Available pages = {4k, thp, 2m, 1g}; see --counters dtlb-misses.\n");
+    printf("         --prefault  Populate and lock all memory, and fail if the runs page-fault\n");
+    printf("    -s | --size      Number of elements of input and output data (default = %zu)\n", nelems);
+    printf("    -t | --type      Element type (default = %s)\n", elem_names[type]);
+    printf("                     Available types = {i8, i16, i32, i64, f32, f64}.\n");
+    printf("         --sweep     Sweep the working set from min to max elements, multiplying the\n");
+    printf("                     size by factor at each step (min:max:factor, e.g. 1024:67108864:2)\n");
+    printf("         --align     Byte offsets of the buffers from a 4 KiB boundary; one for all\n");
+    printf("                     buffers, or src0,src1,dest (multiples of the element size,\n");
+    printf("                     default = 0)\n");
+    printf("         --offset-sweep  Run at every combination of the comma-separated offsets for\n");
+    printf("                     src0, src1 and dest (e.g. 0,4,32,2048)\n");
+    printf("         --prefetch-dist  Distance of the prefetches of vec-pf, in bytes (default = %zu)\n", pf_dist);
+    printf("         --prefetch-hint  Hint of the prefetches of vec-pf (default = %s)\n", pf_hint_names[pf_hint]);
+    printf("                     Available hints = {t0, t1, t2, nta, none}.\n");
+    printf("         --prefetch-sweep  Run vec-pf at each comma-separated distance in bytes with\n");
+    printf("                     each of the t0, t1 and nta hints, against none (e.g. 128,512,2048)\n");
+    printf("         --seed      Seed of the input data generator (default = 0x%x)\n", seed);
     printf("         --nruns     Number of runs to the implementation (default = %d)\n", nruns);
     printf("         --stdevs    Number of standard deviation to exclude outliers (default = %d)\n", nstdevs);
+    printf("         --reps      Invocations per run; 0 calibrates it automatically (default = %d)\n", nreps);
+    printf("         --min-sample-us  Minimum duration of a run when calibrating --reps (default = %d)\n", min_sample_us);
+    printf("         --warmup-ms Maximum time spent warming up; 0 disables warmup (default = %d)\n", warmup_ms);
+    printf("         --ab        Interleave runs of a comma-separated list of implementations in a\n");
+    printf("                     randomized order and report paired differences (e.g. vec,para)\n");
+    printf("         --timer     Timer used to time each run (default = %s)\n", __timer_name(timer.src));
+    printf("                     Available timers = {clock, tsc}.\n");
+    printf("         --counters  Comma-separated performance counters to collect (default = none)\n");
+    printf("                     Available counters = {cycles, instructions, llc-misses,\n");
+    printf("                     branch-misses, dtlb-misses, page-faults, context-switches}.\n");
     printf("\n");
 
     exit(help? 0 : 1);
   }
 
+  /* Topology and thread placement; worker i runs on worker_cpus[i] */
+  topo_t topo;
+  topo_init(&topo);
+
+  int nworkers = (threads_max > nthreads) ? threads_max : nthreads;
+  if (nworkers > TOPO_MAX_CPUS) nworkers = TOPO_MAX_CPUS;
+
+  int worker_cpus[TOPO_MAX_CPUS];
+  if (topo_place(&topo, placement, cpu, nworkers, worker_cpus) < 0) {
+    printf("\n");
+    printf("ERROR: CPU %d is not used by the \"%s\" placement (--cpu)\n",
+                                               cpu, place_names[placement]);
+
+    exit(1);
+  }
+
   /* Set our priority the highest */
   int nice_level = -20;
 
@@ -218,8 +707,8 @@ int main(int argc, char** argv)
   cpu_set_t cpumask;
 
   CPU_ZERO(&cpumask);
-  for (int i = 0; i < nthreads; i++) {
-    CPU_SET((cpu + i) % nthreads, &cpumask);
+  for (int i = 0; i < nworkers; i++) {
+    CPU_SET(worker_cpus[i], &cpumask);
   }
 
   res = sched_setaffinity(pid, sizeof(cpumask), &cpumask);
@@ -230,20 +719,133 @@ int main(int argc, char** argv)
     printf("Succeeded\n");
   }
 #endif
+  topo_print(&topo);
+  topo_print_map(&topo, placement, worker_cpus, nworkers);
   printf("\n");
 
   /* Statistics */
   __DECLARE_STATS(nruns, nstdevs);
 
-  /* Initialize Rand */
-  srand(0xdeadbeef);
+  /* Timer */
+  printf("Calibrating the \"%s\" timer:\n", __timer_name(timer.src));
+  timer_calibrate(&timer);
+  if (timer.src == TIMER_TSC) {
+    printf("  * TSC frequency = %.3f MHz (%s)\n", 1e3 / timer.ns_per_tick,
+                             timer.invariant ? "invariant" : "NOT invariant");
+  }
+  printf("  * Timer source = %s\n", __timer_name(timer.src));
+  printf("  * Timer overhead = %.1f ns (subtracted from every run)\n",
+                                       timer.overhead * timer.ns_per_tick);
+  printf("\n");
+
+  /* Performance counters */
+  if (perf.nevents > 0) {
+    printf("Setting up performance counters:\n");
+    printf("  * Opening a group of %d counter(s):\n", perf.nevents);
+    perf_open(&perf);
+    printf("  * Counting %d counter(s)\n", perf.nevents);
+    printf("\n");
+  }
+
+  /* Worker pool */
+  pool_t pool;
+  if (!spawn) {
+    printf("Setting up the worker pool:\n");
+    printf("  * Starting %d pinned worker(s) ... ", nworkers);
+    if (pool_start(&pool, nworkers, worker_cpus)) {
+      printf("Succeeded\n");
+    } else {
+      printf("Failed, falling back to --spawn\n");
+      pool_stop(&pool);
+      spawn = true;
+    }
+    printf("\n");
+  } else {
+    printf("Spawning worker threads on every invocation (--spawn)\n");
+    printf("\n");
+  }
+
+  /* A sweep reuses one allocation sized for its largest point */
+  if (sweep_min > 0) {
+    nelems    = sweep_max;
+    data_size = nelems * esz;
+  }
+
+  /* Pages backing the datasets */
+  arena_set_pages(pages);
+  arena_set_populate(prefault && numa != NUMA_FIRSTTOUCH);
 
   /* Datasets */
-  /* Allocation and initialization */
-  byte* src0  = __ALLOC_INIT_DATA(byte, data_size + 0);
-  byte* src1  = __ALLOC_INIT_DATA(byte, data_size + 0);
-  byte* ref   = __ALLOC_INIT_DATA(byte, data_size + 4);
-  byte* dest  = __ALLOC_DATA     (byte, data_size + 4);
+  /* Allocation; room to start the buffers at any offset from a page */
+  byte* src0_buf = __ALLOC_DATA(byte, data_size + 0 + ALIGN_PAD);
+  byte* src1_buf = __ALLOC_DATA(byte, data_size + 0 + ALIGN_PAD);
+  byte* dest_buf = __ALLOC_DATA(byte, data_size + 4 + ALIGN_PAD);
+  byte* ref      = __ALLOC_DATA(byte, data_size + 4);
+
+  byte* src0 = align_base(src0_buf) + align[0];
+  byte* src1 = align_base(src1_buf) + align[1];
+  byte* dest = align_base(dest_buf) + align[2];
+
+  /* Workers for placement, generation and the reference */
+  pool_t* p_pool = spawn ? NULL : &pool;
+
+  /* NUMA placement, before anything touches the pages; the slices *
+   * follow the partitioning of the parallel implementation.        */
+  if (numa != NUMA_NONE) {
+    printf("Placing pages (numa = %s, %d slice(s)):\n", numa_names[numa],
+                                                              nworkers);
+    bool placed = true;
+    placed = numa_place(numa, &topo, p_pool, worker_cpus, nworkers,
+                        src0, data_size, esz) && placed;
+    placed = numa_place(numa, &topo, p_pool, worker_cpus, nworkers,
+                        src1, data_size, esz) && placed;
+    placed = numa_place(numa, &topo, p_pool, worker_cpus, nworkers,
+                        dest, data_size, esz) && placed;
+    printf("  * Applying policy .... %s\n", placed ? "Succeeded" : "Failed");
+  }
+
+  /* Initialization: the data only depends on the seed, not on *
+   * the number of workers generating it.                       */
+  if (elem_is_real(type)) {
+    rng_fill_parallel_real(p_pool, worker_cpus, nworkers, src0, data_size, esz, seed, 0);
+    rng_fill_parallel_real(p_pool, worker_cpus, nworkers, src1, data_size, esz, seed, 1);
+  } else {
+    rng_fill_parallel(p_pool, worker_cpus, nworkers, src0, data_size, seed, 0);
+    rng_fill_parallel(p_pool, worker_cpus, nworkers, src1, data_size, seed, 1);
+  }
+  memset(dest, 0, data_size + 4);
+
+  if (numa != NUMA_NONE) {
+    printf("  * Page placement:\n");
+    numa_report("src0", &topo, worker_cpus, nworkers, src0, data_size, esz);
+    numa_report("src1", &topo, worker_cpus, nworkers, src1, data_size, esz);
+    numa_report("dest", &topo, worker_cpus, nworkers, dest, data_size, esz);
+    printf("\n");
+  }
+
+  /* Pages actually obtained, now that they were touched */
+  printf("Page backing (pages = %s):\n", pages_names[pages]);
+  arena_report("src0", src0_buf);
+  arena_report("src1", src1_buf);
+  arena_report("dest", dest_buf);
+  printf("\n");
+
+  printf("Buffer offsets from a 4 KiB boundary (--align):\n");
+  printf("  * src0 = %zu, src1 = %zu, dest = %zu\n", align[0], align[1], align[2]);
+  printf("\n");
+
+  /* Everything is touched by now; keep it resident */
+  if (prefault) {
+    printf("Locking memory (--prefault) .... ");
+    if (!faults_lock()) {
+      printf("Failed\n");
+      printf("\n");
+      printf("ERROR: Cannot lock the memory of --prefault (see ulimit -l)\n");
+      exit(-3);
+    }
+    printf("Succeeded\n");
+    printf("\n");
+  }
 
   /* Setting a guards, which is 0xdeadcafe.
      The guard should not change or be touched. */
@@ -255,179 +857,371 @@ int main(int argc, char** argv)
   args_t args_ref;
 
   args_ref.size     = data_size;
+  args_ref.type     = type;
   args_ref.input0   = src0;
   args_ref.input1   = src1;
   args_ref.output   = ref;
 
   args_ref.cpu      = cpu;
+  args_ref.cpus     = worker_cpus;
   args_ref.nthreads = nthreads;
 
-  /* Running the reference function */
-  impl_ref(&args_ref);
+  args_ref.worker_ns = NULL;
+  args_ref.llc_size  = topo.llc_size;
+  args_ref.pf_dist   = pf_dist;
+  args_ref.pf_hint   = pf_hint;
+  args_ref.pool      = spawn ? NULL : &pool;
+
+  /* Running the reference function, one slice per worker */
+  {
+    args_t slices[nworkers];
+    void*  targs [nworkers];
+    for (int w = 0; w < nworkers; w++) {
+      size_t off, sz;
+      numa_slice(data_size, esz, nworkers, w, &off, &sz);
+
+      slices[w]        = args_ref;
+      slices[w].size   = sz;
+      slices[w].input0 = src0 + off;
+      slices[w].input1 = src1 + off;
+      slices[w].output = ref  + off;
+      targs[w]         = &slices[w];
+    }
+
+    pool_run_once(p_pool, worker_cpus, impl_ref, targs, nworkers);
+  }
 
   /* Execute the requested implementation */
   /* Arguments for the function */
   args_t args;
 
   args.size     = data_size;
+  args.type     = type;
   args.input0   = src0;
   args.input1   = src1;
   args.output   = dest;
 
   args.cpu      = cpu;
+  args.cpus     = worker_cpus;
   args.nthreads = nthreads;
 
-  /* Start execution */
-  printf("Running \"%s\" implementation:\n", impl_str);
-
-  printf("  * Invoking the implementation %d times .... ", num_runs);
-  for (int i = 0; i < num_runs; i++) {
-    __SET_START_TIME();
-    for (int j = 0; j < 16; j++) {
-      (*impl)(&args);
+  args.worker_ns = NULL;
+  args.llc_size  = topo.llc_size;
+  args.pf_dist   = pf_dist;
+  args.pf_hint   = pf_hint;
+  args.pool      = spawn ? NULL : &pool;
+
+  /* Measurement loops on the output of args */
+  output_t out;
+
+  out.args = &args;
+  out.ref  = ref;
+
+  bench_t bench;
+
+  bench.timer         = &timer;
+  bench.perf          = &perf;
+  bench.runtimes      = runtimes;
+  bench.runtimes_mask = runtimes_mask;
+  bench.counters      = counters;
+  bench.num_runs      = num_runs;
+  bench.nstd          = nstd;
+  bench.nelems        = nelems;
+  bench.nreps         = nreps;
+  bench.min_sample_us = min_sample_us;
+  bench.warmup_ms     = warmup_ms;
+  bench.prefault      = prefault;
+  bench.faults_failed = false;
+  bench.verbose       = false;
+  bench.reset         = output_reset;
+  bench.check         = output_check;
+  bench.ctx           = &out;
+
+  /* Two loads and one store per element */
+  bench_rate_t throughput = { 3.0 * data_size, 1.0, "GB/s", "bytes_per_sec" };
+
+  /* Working-set sweep */
+  if (sweep_min > 0) {
+    printf("Running working-set sweep from %zu to %zu elements (x%.2f):\n",
+                                      sweep_min, sweep_max, sweep_factor);
+
+    printf("  * Dumping sweep to sweep.csv .... ");
+    FILE* fp = fopen("sweep.csv", "w");
+    printf("%s\n", (fp != NULL) ? "Succeeded" : "Failed");
+
+    if (fp != NULL) {
+      fprintf(fp, "impl,elements,bytes,invocations_per_run,median_ns,"
+                  "median_ci95_lo,median_ci95_hi,bytes_per_sec,check");
+      perf_csv_header(fp, &perf);
+      fprintf(fp, "\n");
     }
-    __SET_END_TIME();
-    runtimes[i] = __CALC_RUNTIME() / 16;
-  }
-  printf("Finished\n");
-
-  /* Verfication */
-  printf("  * Verifying results .... ");
-  bool match = __CHECK_MATCH(ref, dest, data_size);
-  bool guard = __CHECK_GUARD(     dest, data_size);
-  if (match && guard) {
-    printf("Success\n");
-  } else if (!match && guard) {
-    printf("Fail, but no buffer overruns\n");
-  } else if (match && !guard) {
-    printf("Success, but failed buffer overruns check\n");
-  } else if(!match && !guard) {
-    printf("Failed, and failed buffer overruns check\n");
-  }
 
-  /* Running analytics */
-  uint64_t min     = -1;
-  uint64_t max     =  0;
+    printf("  %-16s %14s %14s %14s %10s", "impl", "elements", "median (ns)",
+                                         "GB/s", "check");
+    perf_header(&perf, "");
+    printf("\n");
+
+    for (size_t elems = sweep_min; elems <= sweep_max; ) {
+      size_t sz = elems * esz;
 
-  uint64_t avg     =  0;
-  uint64_t avg_n   =  0;
+      /* Shrink the working set in place; the guard follows the size */
+      args.size    = sz;
+      bench.nelems = elems;
 
-  uint64_t std     =  0;
-  uint64_t std_n   =  0;
+      /* Two loads and one store per element */
+      bench_rate_t rate = { 3.0 * sz, 1.0, "GB/s", "bytes_per_sec" };
 
-  int      n_msked =  0;
-  int      n_stats =  0;
+      for (int k = 0; k < nsel; k++) {
+        const char*   impl_str = impls[sel[k]].str;
+        bench_point_t pt       = bench_measure(&bench, impls[sel[k]].fn, &args);
 
-  for (int i = 0; i < num_runs; i++)
-    runtimes_mask[i] = true;
+        double gbps = bench_rate(&rate, pt.stats.median);
 
-  printf("  * Running statistics:\n");
-  do {
-    n_stats++;
-    printf("    + Starting statistics run number #%d:\n", n_stats);
-    avg_n =  0;
-    avg   =  0;
-
-    /*   -> Calculate min, max, and avg */
-    for (int i = 0; i < num_runs; i++) {
-      if (runtimes_mask[i]) {
-        if (runtimes[i] < min) {
-          min = runtimes[i];
-        }
-        if (runtimes[i] > max) {
-          max = runtimes[i];
+        printf("  %-16s %14zu %14.1f %14.3f %10s", impl_str, elems,
+                               pt.stats.median, gbps, __PRINT_MATCH(pt.match));
+        perf_row(&perf, &pt.counters, "");
+        printf("\n");
+
+        if (fp != NULL) {
+          fprintf(fp, "%s,%zu,%.0f,%d,%f,%f,%f,%f,%s", impl_str, elems,
+                      rate.work, pt.reps, pt.stats.median, pt.stats.ci_lo,
+                      pt.stats.ci_hi, bench_rate_per_sec(&rate, pt.stats.median),
+                      __PRINT_MATCH(pt.match));
+          perf_csv_row(fp, &perf, &pt.counters);
+          fprintf(fp, "\n");
         }
-        avg += runtimes[i];
-        avg_n += 1;
       }
+
+      /* Next point; always finish on the maximum size */
+      size_t next = (size_t)(elems * sweep_factor);
+      if (next <= elems) next = elems + 1;
+      if (elems < sweep_max && next > sweep_max) next = sweep_max;
+      elems = next;
+    }
+
+    if (fp != NULL) {
+      fclose(fp);
+    }
+    printf("\n");
+
+    /* Restore the full size for the remaining modes */
+    args.size    = data_size;
+    bench.nelems = nelems;
+    output_reset(&out);
+  } else /* Offset sweep: src0, src1 and dest at every combination */
+  if (noffs > 0) {
+    buffers_t bufs;
+
+    bufs.args    = &args;
+    bufs.bufs[0] = src0_buf;
+    bufs.bufs[1] = src1_buf;
+    bufs.bufs[2] = dest_buf;
+    bufs.size    = data_size;
+    memcpy(bufs.cur, align, sizeof(bufs.cur));
+
+    bench_offset_sweep(&bench, impls, sel, nsel, &args, offs, noffs, 3,
+                       buffer_names, buffers_place, &bufs, &throughput);
+
+    /* Restore the offsets of --align for the remaining modes */
+    buffers_place(&bufs, align);
+    src0 = args.input0;
+    src1 = args.input1;
+    dest = args.output;
+    output_reset(&out);
+  } else /* Prefetch sweep: vec-pf at each distance and hint, against none */
+  if (npf_dists > 0) {
+    const pf_hint_t hints[] = { PF_T0, PF_T1, PF_NTA };
+    const int       nhints  = sizeof(hints) / sizeof(hints[0]);
+
+    printf("Running prefetch sweep over %d distance(s) and %d hint(s):\n",
+                                                        npf_dists, nhints);
+
+    printf("  * Dumping sweep to prefetch_sweep.csv .... ");
+    FILE* fp = fopen("prefetch_sweep.csv", "w");
+    printf("%s\n", (fp != NULL) ? "Succeeded" : "Failed");
+
+    if (fp != NULL) {
+      fprintf(fp, "impl,hint,distance,bytes,invocations_per_run,median_ns,"
+                  "median_ci95_lo,median_ci95_hi,bytes_per_sec,speedup,check");
+      perf_csv_header(fp, &perf);
+      fprintf(fp, "\n");
     }
-    avg = avg / avg_n;
 
-    /*   -> Calculate standard deviation */
-    std   =  0;
-    std_n =  0;
+    printf("  %-16s %6s %10s %14s %14s %10s %10s", "impl", "hint", "distance",
+                                 "median (ns)", "GB/s", "vs none", "check");
+    perf_header(&perf, "");
+    printf("\n");
 
-    for (int i = 0; i < num_runs; i++) {
-      if (runtimes_mask[i]) {
-        std   += ((runtimes[i] - avg) *
-                  (runtimes[i] - avg));
-        std_n += 1;
+    /* The first point is the same loop without prefetching */
+    double base = 0.0;
+    for (int p = -1; p < nhints * npf_dists; p++) {
+      void* (*impl)(void* args) = impl_vector_pf;
+      const char* impl_str      = "vectorized_pf";
+      pf_hint_t   hint          = (p < 0) ? PF_NONE : hints[p / npf_dists];
+      const char* hint_str      = pf_hint_names[hint];
+      size_t      dist          = (p < 0) ? 0 : pf_dists[p % npf_dists];
+
+      args.pf_hint = hint;
+      args.pf_dist = dist;
+
+      bench_point_t pt = bench_measure(&bench, impl, &args);
+
+      double gbps    = bench_rate(&throughput, pt.stats.median);
+      if (p < 0) base = pt.stats.median;
+      double speedup = (pt.stats.median > 0.0) ? (base / pt.stats.median) : 0.0;
+
+      printf("  %-16s %6s %10zu %14.1f %14.3f %9.2fx %10s", impl_str, hint_str,
+                   dist, pt.stats.median, gbps, speedup, __PRINT_MATCH(pt.match));
+      perf_row(&perf, &pt.counters, "");
+      printf("\n");
+
+      if (fp != NULL) {
+        fprintf(fp, "%s,%s,%zu,%.0f,%d,%f,%f,%f,%f,%f,%s", impl_str, hint_str,
+                    dist, throughput.work, pt.reps, pt.stats.median,
+                    pt.stats.ci_lo, pt.stats.ci_hi,
+                    bench_rate_per_sec(&throughput, pt.stats.median), speedup,
+                    __PRINT_MATCH(pt.match));
+        perf_csv_row(fp, &perf, &pt.counters);
+        fprintf(fp, "\n");
       }
     }
-    std = sqrt(std / std_n);
-
-    /*   -> Calculate outlier-free average (mean) */
-    n_msked = 0;
-    for (int i = 0; i < num_runs; i++) {
-      if (runtimes_mask[i]) {
-        if (runtimes[i] > avg) {
-          if ((runtimes[i] - avg) > (nstd * std)) {
-            runtimes_mask[i] = false;
-            n_msked += 1;
-          }
-        } else {
-          if ((avg - runtimes[i]) > (nstd * std)) {
-            runtimes_mask[i] = false;
-            n_msked += 1;
-          }
+
+    if (fp != NULL) {
+      fclose(fp);
+    }
+    printf("\n");
+
+    /* Restore the requested prefetching for the remaining modes */
+    args.pf_dist = pf_dist;
+    args.pf_hint = pf_hint;
+  } else /* Thread-scaling sweep of the parallel implementation */
+  if (threads_max > 0) {
+    bench_threads_sweep(&bench, impl_parallel, &args, threads_set,
+                        threads_min, threads_max, &throughput);
+
+    /* Restore the requested thread count for the remaining modes */
+    args.nthreads = nthreads;
+  } else {
+    /* Run all selected implementations on the same buffers */
+    double medians[IMPL_MAX];
+    bool   matches[IMPL_MAX];
+
+    /* Follow every step of the measurement */
+    bench.verbose = true;
+
+    for (int k = 0; k < nsel; k++) {
+      void* (*impl)(void* args) = impls[sel[k]].fn;
+      const char* impl_str      = impls[sel[k]].str;
+
+      /* Start execution */
+      printf("Running \"%s\" implementation:\n", impl_str);
+      bench_point_t pt = bench_measure(&bench, impl, &args);
+
+      /* Running analytics */
+      stats_t stats = pt.stats;
+
+      printf("  * Running statistics:\n");
+      stats_print(&stats);
+
+      /* Display information */
+      printf("  * Runtimes (%s): ", __PRINT_MATCH(pt.match));
+      printf(" %.1f ns\n"        , stats.median        );
+      printf("  * Throughput (%s): %.3f GB/s, %.3f Gop/s\n", elem_names[type],
+                            (stats.median > 0.0) ? (3.0 * data_size / stats.median) : 0.0,
+                            (stats.median > 0.0) ? (nelems / stats.median) : 0.0);
+
+      /* Performance counters */
+      perf_summary(&perf, counters, runtimes_mask, num_runs, nelems);
+
+      /* Dump */
+      printf("  * Dumping runtime informations:\n");
+      FILE * fp;
+      char filename[256];
+      strcpy(filename, impl_str);
+      strcat(filename, "_runtimes.csv");
+      printf("    - Filename: %s\n", filename);
+      printf("    - Opening file .... ");
+      fp = fopen(filename, "w");
+
+      if (fp != NULL) {
+        printf("Succeeded\n");
+        printf("    - Writing runtimes ... ");
+        fprintf(fp, "impl,%s", impl_str);
+
+        fprintf(fp, "\n");
+        fprintf(fp, "type,%s", elem_names[type]);
+
+        fprintf(fp, "\n");
+        fprintf(fp, "elements,%zu", nelems);
+
+        fprintf(fp, "\n");
+        fprintf(fp, "timer,%s", __timer_name(timer.src));
+
+        fprintf(fp, "\n");
+        fprintf(fp, "timer_overhead_ns,%f", timer.overhead * timer.ns_per_tick);
+
+        fprintf(fp, "\n");
+        fprintf(fp, "num_of_runs,%d", num_runs);
+
+        fprintf(fp, "\n");
+        fprintf(fp, "invocations_per_run,%d", pt.reps);
+
+        fprintf(fp, "\n");
+        fprintf(fp, "minor_faults,%" PRIu64 "", pt.faults.minor);
+
+        fprintf(fp, "\n");
+        fprintf(fp, "major_faults,%" PRIu64 "", pt.faults.major);
+
+        fprintf(fp, "\n");
+        fprintf(fp, "runtimes");
+        for (int i = 0; i < num_runs; i++) {
+          fprintf(fp, ", ");
+          fprintf(fp, "%.3f", runtimes[i]);
         }
+
+        stats_dump(fp, &stats);
+        perf_dump(fp, &perf, counters, runtimes_mask, num_runs, nelems);
+        printf("Finished\n");
+        printf("    - Closing file handle .... ");
+        fclose(fp);
+        printf("Finished\n");
+      } else {
+        printf("Failed\n");
       }
-    }
+      printf("\n");
 
-    printf("      - Standard deviation = %" PRIu64 "\n", std);
-    printf("      - Average = %" PRIu64 "\n", avg);
-    printf("      - Number of active elements = %" PRIu64 "\n", avg_n);
-    printf("      - Number of masked-off = %d\n", n_msked);
-  } while (n_msked > 0);
-  /* Display information */
-  printf("  * Runtimes (%s): ", __PRINT_MATCH(match));
-  printf(" %" PRIu64 " ns\n"  , avg                 );
-
-  /* Dump */
-  printf("  * Dumping runtime informations:\n");
-  FILE * fp;
-  char filename[256];
-  strcpy(filename, impl_str);
-  strcat(filename, "_runtimes.csv");
-  printf("    - Filename: %s\n", filename);
-  printf("    - Opening file .... ");
-  fp = fopen(filename, "w");
-
-  if (fp != NULL) {
-    printf("Succeeded\n");
-    printf("    - Writing runtimes ... ");
-    fprintf(fp, "impl,%s", impl_str);
+      medians[k] = stats.median;
+      matches[k] = pt.match;
+    }
 
-    fprintf(fp, "\n");
-    fprintf(fp, "num_of_runs,%d", num_runs);
+    bench.verbose = false;
 
-    fprintf(fp, "\n");
-    fprintf(fp, "runtimes");
-    for (int i = 0; i < num_runs; i++) {
-      fprintf(fp, ", ");
-      fprintf(fp, "%" PRIu64 "", runtimes[i]);
+    /* Comparison table */
+    if (nsel > 1) {
+      impl_summary(impls, sel, nsel, medians, matches,
+                   3.0 * data_size, 1.0, "GB/s");
     }
+  }
 
-    fprintf(fp, "\n");
-    fprintf(fp, "avg,%" PRIu64 "", avg);
-    printf("Finished\n");
-    printf("    - Closing file handle .... ");
-    fclose(fp);
-    printf("Finished\n");
-  } else {
-    printf("Failed\n");
+  /* Interleaved A/B comparison */
+  if (nab > 0) {
+    bench_ab(&bench, impls, ab_sel, nab, &args);
   }
-  printf("\n");
 
   /* Manage memory */
-  free(src0);
-  free(src1);
-  free(dest);
-  free(ref);
+  __FREE_DATA(src0_buf);
+  __FREE_DATA(src1_buf);
+  __FREE_DATA(dest_buf);
+  __FREE_DATA(ref);
+
+  /* Stop the worker pool */
+  if (!spawn) {
+    pool_stop(&pool);
+  }
 
   /* Finished with statistics */
   __DESTROY_STATS();
 
-  /* Done */
-  return 0;
+  /* Done; page faults under --prefault fail the run */
+  return bench.faults_failed ? -3 : 0;
 }